@@ -0,0 +1,266 @@
+// craftworld_bench.cpp
+// Timings and allocation counts for the core operations, emitted as JSON to track regressions between versions
+
+#include <craftworld/craftworld.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef CRAFTWORLD_PROBLEMS_DIR
+#define CRAFTWORLD_PROBLEMS_DIR "problems"
+#endif
+
+// Count every allocation made by the process, so the allocations made by an operation can be reported.
+// GCC flags the free() in the replaced operator delete once the replaced operator new is inlined into callers.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+std::atomic<uint64_t> alloc_count{0};
+std::atomic<uint64_t> alloc_bytes{0};
+}    // namespace
+
+auto operator new(std::size_t size) -> void * {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator new[](std::size_t size) -> void * {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace craftworld;
+
+namespace {
+// Keeps benchmarked results alive so the work is not optimised away
+volatile uint64_t sink = 0;
+
+struct BenchResult {
+    std::string name;
+    std::string level_set;
+    uint64_t ops;
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_per_op;
+};
+
+// Run func(ops) with a growing op count until it takes at least min_time, then report the last run
+template <typename Func>
+auto run_bench(const std::string &name, const std::string &level_set, double min_time, Func func) -> BenchResult {
+    uint64_t ops = 1;
+    while (true) {
+        const auto count_before = alloc_count.load();
+        const auto bytes_before = alloc_bytes.load();
+        const auto start = std::chrono::steady_clock::now();
+        func(ops);
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= min_time || ops >= (uint64_t{1} << 40)) {
+            const auto num_ops = static_cast<double>(ops);
+            return {
+                .name = name,
+                .level_set = level_set,
+                .ops = ops,
+                .ns_per_op = elapsed * 1e9 / num_ops,    // NOLINT(*-magic-numbers)
+                .allocs_per_op = static_cast<double>(alloc_count.load() - count_before) / num_ops,
+                .bytes_per_op = static_cast<double>(alloc_bytes.load() - bytes_before) / num_ops,
+            };
+        }
+        ops *= 2;
+    }
+}
+
+auto read_lines(const std::string &path) -> std::vector<std::string> {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+// Fixed action sequence shared by the stepping benchmarks, so runs are comparable
+auto make_actions(std::size_t n) -> std::vector<Action> {
+    std::mt19937 rng(0);
+    std::vector<Action> actions(n);
+    for (auto &action : actions) {
+        action = static_cast<Action>(rng() % kNumActions);
+    }
+    return actions;
+}
+
+void bench_level_set(const std::string &level_set, const std::vector<std::string> &board_strs, double min_time,
+                     std::vector<BenchResult> &results) {
+    std::vector<CraftWorldGameState> levels;
+    for (const auto &board_str : board_strs) {
+        levels.emplace_back(board_str);
+    }
+    const auto actions = make_actions(4096);    // NOLINT(*-magic-numbers)
+    const auto num_levels = levels.size();
+    std::vector<float> obs(levels[0].get_observation().size());
+    std::vector<uint8_t> img;
+
+    results.push_back(run_bench("construct_from_str", level_set, min_time, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; ++i) {
+            const CraftWorldGameState state(board_strs[i % num_levels]);
+            sink = sink + state.get_hash();
+        }
+    }));
+    results.push_back(run_bench("copy", level_set, min_time, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; ++i) {
+            const CraftWorldGameState state = levels[i % num_levels];
+            sink = sink + state.get_hash();
+        }
+    }));
+    results.push_back(run_bench("apply_action", level_set, min_time, [&](uint64_t ops) {
+        auto state = levels[0];
+        for (uint64_t i = 0; i < ops; ++i) {
+            state.apply_action(actions[i % actions.size()]);
+        }
+        sink = sink + state.get_hash();
+    }));
+    results.push_back(run_bench("get_observation", level_set, min_time, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; ++i) {
+            sink = sink + levels[i % num_levels].get_observation().size();
+        }
+    }));
+    results.push_back(run_bench("write_observation", level_set, min_time, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; ++i) {
+            levels[i % num_levels].write_observation(obs);
+        }
+        sink = sink + static_cast<uint64_t>(obs[0]);
+    }));
+    results.push_back(run_bench("to_image", level_set, min_time, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; ++i) {
+            sink = sink + levels[i % num_levels].to_image().size();
+        }
+    }));
+    results.push_back(run_bench("write_image", level_set, min_time, [&](uint64_t ops) {
+        img.resize(levels[0].to_image().size());
+        for (uint64_t i = 0; i < ops; ++i) {
+            levels[i % num_levels].write_image(img);
+        }
+        sink = sink + img[0];
+    }));
+
+    // Random rollouts as used for training: step, then patch the observation
+    results.push_back(run_bench("rollout_step", level_set, min_time, [&](uint64_t ops) {
+        std::size_t level_idx = 0;
+        auto state = levels[level_idx];
+        state.write_observation(obs);
+        for (uint64_t i = 0; i < ops; ++i) {
+            state.apply_action(actions[i % actions.size()]);
+            if (state.is_solution()) {
+                level_idx = (level_idx + 1) % num_levels;
+                state = levels[level_idx];
+                state.write_observation(obs);
+            } else {
+                state.update_observation(obs);
+            }
+        }
+        sink = sink + state.get_hash();
+    }));
+
+    // Construct the envs once so only stepping is timed, resetting each run to the same start
+    constexpr int kNumEnvs = 64;
+    CraftWorldVecEnv env(board_strs, kNumEnvs);
+    std::vector<int> env_actions(kNumEnvs);
+    results.push_back(run_bench("vec_env_step_64", level_set, min_time, [&](uint64_t ops) {
+        env.reset();
+        for (uint64_t i = 0; i < ops; i += kNumEnvs) {
+            for (std::size_t j = 0; j < env_actions.size(); ++j) {
+                env_actions[j] = static_cast<int>(actions[(i + j) % actions.size()]);
+            }
+            env.step(env_actions);
+        }
+        sink = sink + env.reward_signals()[0];
+    }));
+}
+
+void write_json(std::ostream &os, const std::vector<BenchResult> &results) {
+    os << "{\n";
+    os << "  \"max_inline_board_dim\": " << kMaxInlineBoardDim << ",\n";
+    os << "  \"hash_128\": " << (kHash128 ? "true" : "false") << ",\n";
+    os << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto &r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"level_set\": \"" << r.level_set << "\", \"ops\": " << r.ops
+           << ", \"ns_per_op\": " << r.ns_per_op << ", \"ops_per_sec\": " << (1e9 / r.ns_per_op)    // NOLINT
+           << ", \"allocs_per_op\": " << r.allocs_per_op << ", \"bytes_per_op\": " << r.bytes_per_op << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n";
+    os << "}\n";
+}
+}    // namespace
+
+int main(int argc, char **argv) {
+    std::string problems_dir = CRAFTWORLD_PROBLEMS_DIR;
+    std::string out_path;
+    double min_time = 0.2;    // NOLINT(*-magic-numbers)
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--problems-dir" && i + 1 < argc) {
+            problems_dir = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_time = std::atof(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            std::cerr << "usage: craftworld_bench [--problems-dir DIR] [--min-time SECONDS] [--out FILE]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    try {
+        for (const auto &level_set : {"test_100", "test_100_hard"}) {
+            bench_level_set(level_set, read_lines(problems_dir + "/" + level_set + ".txt"), min_time, results);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (out_path.empty()) {
+        write_json(std::cout, results);
+    } else {
+        std::ofstream file(out_path);
+        write_json(file, results);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+"""Time the Python bindings for the operations measured by craftworld_bench, to track binding overhead.
+
+Output is JSON in the same layout as craftworld_bench, so the ns_per_op of matching names can be compared.
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+import numpy as np
+
+import pycraftworld
+
+kProblemsDir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "problems")
+kLevelSets = ["test_100", "test_100_hard"]
+
+
+def run_bench(name, level_set, min_time, func):
+    ops = 1
+    while True:
+        start = time.perf_counter()
+        func(ops)
+        elapsed = time.perf_counter() - start
+        if elapsed >= min_time:
+            ns_per_op = elapsed * 1e9 / ops
+            return {
+                "name": name,
+                "level_set": level_set,
+                "ops": ops,
+                "ns_per_op": ns_per_op,
+                "ops_per_sec": 1e9 / ns_per_op,
+            }
+        ops *= 2
+
+
+def bench_level_set(level_set, board_strs, min_time):
+    levels = [pycraftworld.CraftWorldGameState(board_str) for board_str in board_strs]
+    actions = np.random.default_rng(0).integers(pycraftworld.CraftWorldGameState.num_actions, size=4096).tolist()
+    obs = np.zeros(levels[0].observation_shape(), dtype=np.float32)
+    img = np.zeros(levels[0].image_shape(), dtype=np.uint8)
+    results = []
+
+    def construct_from_str(ops):
+        for i in range(ops):
+            pycraftworld.CraftWorldGameState(board_strs[i % len(board_strs)])
+
+    def copy(ops):
+        for i in range(ops):
+            levels[i % len(levels)].__copy__()
+
+    def apply_action(ops):
+        state = levels[0].__copy__()
+        for i in range(ops):
+            state.apply_action(actions[i % len(actions)])
+
+    def get_observation(ops):
+        for i in range(ops):
+            levels[i % len(levels)].get_observation()
+
+    def write_observation(ops):
+        for i in range(ops):
+            levels[i % len(levels)].write_observation(obs)
+
+    def to_image(ops):
+        for i in range(ops):
+            levels[i % len(levels)].to_image()
+
+    def write_image(ops):
+        for i in range(ops):
+            levels[i % len(levels)].write_image(img)
+
+    def rollout_step(ops):
+        level_idx = 0
+        state = levels[level_idx].__copy__()
+        state.write_observation(obs)
+        for i in range(ops):
+            state.apply_action(actions[i % len(actions)])
+            if state.is_solution():
+                level_idx = (level_idx + 1) % len(levels)
+                state = levels[level_idx].__copy__()
+                state.write_observation(obs)
+            else:
+                state.update_observation(obs)
+
+    # Construct the envs once so only stepping is timed, resetting each run to the same start
+    num_envs = 64
+    env = pycraftworld.CraftWorldVecEnv(board_strs, num_envs)
+    env_actions = np.array(actions, dtype=np.int32)
+
+    def vec_env_step_64(ops):
+        env.reset()
+        for i in range(0, ops, num_envs):
+            start = i % (len(actions) - num_envs)
+            env.step(env_actions[start : start + num_envs])
+
+    for name, func in [
+        ("construct_from_str", construct_from_str),
+        ("copy", copy),
+        ("apply_action", apply_action),
+        ("get_observation", get_observation),
+        ("write_observation", write_observation),
+        ("to_image", to_image),
+        ("write_image", write_image),
+        ("rollout_step", rollout_step),
+        ("vec_env_step_64", vec_env_step_64),
+    ]:
+        results.append(run_bench(name, level_set, min_time, func))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--problems_dir", default=kProblemsDir, type=str)
+    parser.add_argument("--min_time", default=0.2, type=float)
+    parser.add_argument("--out", default=None, type=str)
+    args = parser.parse_args()
+
+    results = []
+    for level_set in kLevelSets:
+        with open(os.path.join(args.problems_dir, level_set + ".txt")) as f:
+            board_strs = [line.strip() for line in f if line.strip()]
+        results += bench_level_set(level_set, board_strs, args.min_time)
+
+    output = json.dumps({"python": sys.version.split()[0], "results": results}, indent=2)
+    if args.out is None:
+        print(output)
+    else:
+        with open(args.out, "w") as f:
+            f.write(output + "\n")
+
+
+if __name__ == "__main__":
+    main()
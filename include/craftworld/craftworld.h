@@ -1,6 +1,17 @@
 #ifndef CRAFTWORLD_H_
 #define CRAFTWORLD_H_
 
+#include "../../src/craftworld_arena.h"
 #include "../../src/craftworld_base.h"
+#include "../../src/craftworld_batch.h"
+#include "../../src/craftworld_distance.h"
+#include "../../src/craftworld_generator.h"
+#include "../../src/craftworld_instrumentation.h"
+#include "../../src/craftworld_levels.h"
+#include "../../src/craftworld_renderer.h"
+#include "../../src/craftworld_rollout.h"
+#include "../../src/craftworld_solver.h"
+#include "../../src/craftworld_trajectory.h"
+#include "../../src/craftworld_vec_env.h"
 
 #endif    // CRAFTWORLD_H_
\ No newline at end of file
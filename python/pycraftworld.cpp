@@ -10,6 +10,36 @@
 
 namespace py = pybind11;
 
+namespace {
+// View into a buffer owned by base, which is kept alive as long as the view
+template <typename T>
+auto make_view(const T *data, const std::vector<py::ssize_t> &shape, py::handle base) -> py::array_t<T> {
+    return py::array_t<T>(shape, data, base);
+}
+
+// View of the contents of a bytes object, valid while it is alive
+auto bytes_view(const py::bytes &bytes) -> std::span<const uint8_t> {
+    char *data = nullptr;
+    py::ssize_t size = 0;
+    if (PyBytes_AsStringAndSize(bytes.ptr(), &data, &size) != 0) {
+        throw py::error_already_set();
+    }
+    return {reinterpret_cast<const uint8_t *>(data), static_cast<std::size_t>(size)};
+}
+
+// Pointers to the states in a Python sequence, which must be gathered while holding the GIL.
+// The tuple keeps the state objects alive if the sequence is modified by another thread once the GIL is released.
+template <typename StatePtr>
+auto state_ptrs(const py::tuple &states) -> std::vector<StatePtr> {
+    std::vector<StatePtr> ptrs;
+    ptrs.reserve(states.size());
+    for (const auto &state : states) {
+        ptrs.push_back(&state.cast<std::remove_pointer_t<StatePtr> &>());
+    }
+    return ptrs;
+}
+}    // namespace
+
 PYBIND11_MODULE(pycraftworld, m) {
     m.doc() = "CraftWorld environment module docs.";
     namespace cw = ::craftworld;
@@ -68,6 +98,8 @@ PYBIND11_MODULE(pycraftworld, m) {
         .value("kRewardCodeUseAtWorkstation3", cw::RewardCode::kRewardCodeUseAtWorkstation3)
         .value("kRewardCodeUseAtFurnace", cw::RewardCode::kRewardCodeUseAtFurnace);
 
+    py::class_<T::UndoRecord>(m, "UndoRecord");
+
     py::class_<T>(m, "CraftWorldGameState")
         .def(py::init<const std::string &>())
         .def_readonly_static("name", &T::name)
@@ -75,6 +107,12 @@ PYBIND11_MODULE(pycraftworld, m) {
         .def(py::self == py::self)    // NOLINT (misc-redundant-expression)
         .def(py::self != py::self)    // NOLINT (misc-redundant-expression)
         .def("__hash__", [](const T &self) { return self.get_hash(); })
+        .def("get_hash", &T::get_hash)
+        .def("get_hash128",
+             [](const T &self) {
+                 const auto hash = self.get_hash128();
+                 return py::make_tuple(hash.lo, hash.hi);
+             })
         .def("__copy__", [](const T &self) { return T(self); })
         .def("__deepcopy__", [](const T &self, py::dict) { return T(self); })
         .def("__repr__",
@@ -83,13 +121,24 @@ PYBIND11_MODULE(pycraftworld, m) {
                  stream << self;
                  return stream.str();
              })
+        .def("to_bytes",
+             [](const T &self) {
+                 const auto bytes = self.to_bytes();
+                 return py::bytes(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+             })
+        .def_static(
+            "from_bytes", [](const py::bytes &bytes) { return T::from_bytes(bytes_view(bytes)); }, py::arg("data"))
         .def(py::pickle(
             [](const T &self) {    // __getstate__
-                auto s = self.pack();
-                return py::make_tuple(s.rows, s.cols, s.agent_idx, s.grid, s.goal, s.reward_signal, s.hash,
-                                      s.inventory);
+                const auto bytes = self.to_bytes();
+                return py::bytes(reinterpret_cast<const char *>(bytes.data()), bytes.size());
             },
-            [](py::tuple t) -> T {    // __setstate__
+            [](const py::object &state) -> T {    // __setstate__
+                if (py::isinstance<py::bytes>(state)) {
+                    return T::from_bytes(bytes_view(state.cast<py::bytes>()));
+                }
+                // Tuple layout of pickles made before the binary encoding
+                const auto t = state.cast<py::tuple>();
                 if (t.size() != 8) {
                     throw std::runtime_error("Invalid state");
                 }
@@ -111,25 +160,526 @@ PYBIND11_MODULE(pycraftworld, m) {
                  }
                  self.apply_action(static_cast<craftworld::Action>(action));
              })
+        .def("apply_action_with_undo",
+             [](T &self, int action) {
+                 if (action < 0 || action >= T::action_space_size()) {
+                     throw std::invalid_argument("Invalid action.");
+                 }
+                 return self.apply_action_with_undo(static_cast<craftworld::Action>(action));
+             })
+        .def("undo", &T::undo)
+        .def("effective_action_mask", &T::effective_action_mask)
         .def("is_solution", &T::is_solution)
         .def("observation_shape", &T::observation_shape)
         .def("get_observation",
              [](const T &self) {
-                 py::array_t<float> out = py::cast(self.get_observation());
-                 return out.reshape(self.observation_shape());
+                 const auto [c, h, w] = self.observation_shape();
+                 py::array_t<float> out({c, h, w});
+                 float *out_data = out.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     self.write_observation({out_data, static_cast<std::size_t>(c * h * w)});
+                 }
+                 return out;
              })
-        .def("image_shape", &T::image_shape)
-        .def("to_image",
-             [](T &self) {
-                 py::array_t<uint8_t> out = py::cast(self.to_image());
-                 const auto obs_shape = self.observation_shape();
-                 return out.reshape({static_cast<py::ssize_t>(obs_shape[1] * craftworld::SPRITE_HEIGHT),
-                                     static_cast<py::ssize_t>(obs_shape[2] * craftworld::SPRITE_WIDTH),
-                                     static_cast<py::ssize_t>(craftworld::SPRITE_CHANNELS)});
+        .def(
+            "write_observation",
+            [](const T &self, py::array_t<float, py::array::c_style> &out) {
+                self.write_observation({out.mutable_data(), static_cast<std::size_t>(out.size())});
+            },
+            py::arg("out").noconvert())
+        .def(
+            "update_observation",
+            [](const T &self, py::array_t<float, py::array::c_style> &out) {
+                self.update_observation({out.mutable_data(), static_cast<std::size_t>(out.size())});
+            },
+            py::arg("out").noconvert())
+        .def_static("egocentric_observation_shape", &T::egocentric_observation_shape, py::arg("radius"))
+        .def(
+            "get_egocentric_observation",
+            [](const T &self, int radius) {
+                if (radius < 0) {
+                    throw std::invalid_argument("Observation radius must be non-negative.");
+                }
+                const auto [c, h, w] = T::egocentric_observation_shape(radius);
+                py::array_t<float> out({c, h, w});
+                const std::span<float> obs(out.mutable_data(), static_cast<std::size_t>(out.size()));
+                {
+                    py::gil_scoped_release release;
+                    self.write_egocentric_observation(obs, radius);
+                }
+                return out;
+            },
+            py::arg("radius"))
+        .def(
+            "write_egocentric_observation",
+            [](const T &self, py::array_t<float, py::array::c_style> &out, int radius) {
+                self.write_egocentric_observation({out.mutable_data(), static_cast<std::size_t>(out.size())}, radius);
+            },
+            py::arg("out").noconvert(), py::arg("radius"))
+        .def("get_inventory_observation",
+             [](const T &self) {
+                 py::array_t<float> out(cw::kInventoryObservationSize);
+                 self.write_inventory_observation({out.mutable_data(), static_cast<std::size_t>(out.size())});
+                 return out;
+             })
+        .def(
+            "write_inventory_observation",
+            [](const T &self, py::array_t<float, py::array::c_style> &out) {
+                self.write_inventory_observation({out.mutable_data(), static_cast<std::size_t>(out.size())});
+            },
+            py::arg("out").noconvert())
+        .def("get_observation_uint8",
+             [](const T &self) {
+                 const auto [c, h, w] = self.observation_shape();
+                 py::array_t<uint8_t> out({c, h, w});
+                 self.write_observation_uint8({out.mutable_data(), static_cast<std::size_t>(out.size())});
+                 return out;
+             })
+        .def(
+            "write_observation_uint8",
+            [](const T &self, py::array_t<uint8_t, py::array::c_style> &out) {
+                self.write_observation_uint8({out.mutable_data(), static_cast<std::size_t>(out.size())});
+            },
+            py::arg("out").noconvert())
+        .def("packed_observation_size", &T::packed_observation_size)
+        .def("get_observation_packed",
+             [](const T &self) {
+                 py::array_t<uint8_t> out(self.packed_observation_size());
+                 self.write_observation_packed({out.mutable_data(), static_cast<std::size_t>(out.size())});
+                 return out;
              })
+        .def(
+            "write_observation_packed",
+            [](const T &self, py::array_t<uint8_t, py::array::c_style> &out) {
+                self.write_observation_packed({out.mutable_data(), static_cast<std::size_t>(out.size())});
+            },
+            py::arg("out").noconvert())
+        .def("image_shape", &T::image_shape, py::arg("tile_size") = cw::SPRITE_WIDTH)
+        .def(
+            "to_image",
+            [](T &self, int tile_size) {
+                const auto [h, w, c] = self.image_shape(tile_size);
+                py::array_t<uint8_t> out({h, w, c});
+                uint8_t *out_data = out.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    self.write_image({out_data, static_cast<std::size_t>(h * w * c)}, tile_size);
+                }
+                return out;
+            },
+            py::arg("tile_size") = cw::SPRITE_WIDTH)
+        .def(
+            "write_image",
+            [](const T &self, py::array_t<uint8_t, py::array::c_style> &out, int tile_size) {
+                const std::span<uint8_t> img(out.mutable_data(), static_cast<std::size_t>(out.size()));
+                py::gil_scoped_release release;
+                self.write_image(img, tile_size);
+            },
+            py::arg("out").noconvert(), py::arg("tile_size") = cw::SPRITE_WIDTH)
         .def("get_reward_signal", &T::get_reward_signal)
         .def("get_agent_index", &T::get_agent_index)
+        .def("get_goal", &T::get_goal)
+        .def("get_board_shape", &T::get_board_shape)
+        .def("get_element", &T::get_element)
         .def("get_indices", &T::get_indices)
         .def("add_to_inventory", &T::add_to_inventory)
         .def("check_inventory", &T::check_inventory);
+
+    using RendererT = cw::CraftWorldRenderer;
+    py::class_<RendererT>(m, "CraftWorldRenderer")
+        .def(py::init<int>(), py::arg("tile_size") = cw::SPRITE_WIDTH)
+        .def("image_shape", &RendererT::image_shape)
+        .def("tile_size", &RendererT::tile_size)
+        .def("reset", &RendererT::reset)
+        .def("render", [](RendererT &self, const T &state) {
+            const auto frame = self.render(state);
+            const auto [h, w, c] = self.image_shape();
+            return make_view(frame.data(), {h, w, c}, py::cast(&self));
+        });
+
+    m.def(
+        "unpack_observations",
+        [](const py::array_t<uint8_t, py::array::c_style | py::array::forcecast> &packed,
+           const std::array<int, 3> &obs_shape) {
+            const auto obs_size = static_cast<std::size_t>(obs_shape[0] * obs_shape[1] * obs_shape[2]);
+            const auto packed_size = (obs_size + 7) / 8;
+            if (packed.ndim() == 0 || static_cast<std::size_t>(packed.shape(packed.ndim() - 1)) != packed_size) {
+                throw std::invalid_argument("Last dimension of packed does not match the packed observation size.");
+            }
+            // Leading batch dimensions are kept, last dimension is expanded to CHW
+            std::vector<py::ssize_t> out_shape(packed.shape(), packed.shape() + packed.ndim() - 1);
+            out_shape.insert(out_shape.end(), obs_shape.begin(), obs_shape.end());
+            py::array_t<float> out(out_shape);
+            const auto batch_size = static_cast<std::size_t>(packed.size()) / packed_size;
+            const uint8_t *packed_data = packed.data();
+            float *out_data = out.mutable_data();
+            {
+                py::gil_scoped_release release;
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    cw::unpack_observation({packed_data + i * packed_size, packed_size},
+                                           {out_data + i * obs_size, obs_size});
+                }
+            }
+            return out;
+        },
+        py::arg("packed"), py::arg("obs_shape"));
+
+    m.def(
+        "step_states",
+        [](const py::sequence &states, const py::array_t<int, py::array::c_style | py::array::forcecast> &actions) {
+            const py::tuple held(states);
+            const auto ptrs = state_ptrs<T *>(held);
+            const auto [c, h, w] = cw::batch_observation_shape({ptrs.begin(), ptrs.end()});
+            const auto n = static_cast<py::ssize_t>(ptrs.size());
+            py::array_t<float> obs({n, static_cast<py::ssize_t>(c), static_cast<py::ssize_t>(h),
+                                    static_cast<py::ssize_t>(w)});
+            py::array_t<uint64_t> reward_signals(n);
+            py::array_t<bool> solved(n);
+            const std::span<float> obs_span(obs.mutable_data(), static_cast<std::size_t>(obs.size()));
+            const std::span<uint64_t> reward_span(reward_signals.mutable_data(), ptrs.size());
+            const std::span<uint8_t> solved_span(reinterpret_cast<uint8_t *>(solved.mutable_data()), ptrs.size());
+            {
+                py::gil_scoped_release release;
+                cw::step_states(ptrs, {actions.data(), static_cast<std::size_t>(actions.size())}, obs_span,
+                                reward_span, solved_span);
+            }
+            return py::make_tuple(obs, reward_signals, solved);
+        },
+        py::arg("states"), py::arg("actions"));
+    m.def(
+        "get_observations",
+        [](const py::sequence &states) {
+            const py::tuple held(states);
+            const auto ptrs = state_ptrs<const T *>(held);
+            const auto [c, h, w] = cw::batch_observation_shape(ptrs);
+            py::array_t<float> obs({static_cast<py::ssize_t>(ptrs.size()), static_cast<py::ssize_t>(c),
+                                    static_cast<py::ssize_t>(h), static_cast<py::ssize_t>(w)});
+            const std::span<float> obs_span(obs.mutable_data(), static_cast<std::size_t>(obs.size()));
+            {
+                py::gil_scoped_release release;
+                cw::write_observations(ptrs, obs_span);
+            }
+            return obs;
+        },
+        py::arg("states"));
+    m.attr("kInventoryObservationSize") = cw::kInventoryObservationSize;
+    m.def(
+        "get_egocentric_observations",
+        [](const py::sequence &states, int radius) {
+            const py::tuple held(states);
+            const auto ptrs = state_ptrs<const T *>(held);
+            if (radius < 0) {
+                throw std::invalid_argument("Observation radius must be non-negative.");
+            }
+            const auto [c, h, w] = T::egocentric_observation_shape(radius);
+            const auto n = static_cast<py::ssize_t>(ptrs.size());
+            py::array_t<float> obs({n, static_cast<py::ssize_t>(c), static_cast<py::ssize_t>(h),
+                                    static_cast<py::ssize_t>(w)});
+            py::array_t<float> inventory({n, static_cast<py::ssize_t>(cw::kInventoryObservationSize)});
+            const std::span<float> obs_span(obs.mutable_data(), static_cast<std::size_t>(obs.size()));
+            const std::span<float> inventory_span(inventory.mutable_data(), static_cast<std::size_t>(inventory.size()));
+            {
+                py::gil_scoped_release release;
+                cw::write_egocentric_observations(ptrs, obs_span, radius);
+                cw::write_inventory_observations(ptrs, inventory_span);
+            }
+            return py::make_tuple(obs, inventory);
+        },
+        py::arg("states"), py::arg("radius"));
+    m.def(
+        "get_images",
+        [](const py::sequence &states, int tile_size) {
+            const py::tuple held(states);
+            const auto ptrs = state_ptrs<const T *>(held);
+            if (ptrs.empty()) {
+                throw std::invalid_argument("At least one state is required.");
+            }
+            const auto [h, w, c] = ptrs.front()->image_shape(tile_size);
+            py::array_t<uint8_t> imgs({static_cast<py::ssize_t>(ptrs.size()), static_cast<py::ssize_t>(h),
+                                       static_cast<py::ssize_t>(w), static_cast<py::ssize_t>(c)});
+            const std::span<uint8_t> imgs_span(imgs.mutable_data(), static_cast<std::size_t>(imgs.size()));
+            {
+                py::gil_scoped_release release;
+                cw::write_images(ptrs, imgs_span, tile_size);
+            }
+            return imgs;
+        },
+        py::arg("states"), py::arg("tile_size") = cw::SPRITE_WIDTH);
+    m.def(
+        "get_action_masks",
+        [](const py::sequence &states) {
+            const py::tuple held(states);
+            const auto ptrs = state_ptrs<const T *>(held);
+            py::array_t<uint8_t> masks(static_cast<py::ssize_t>(ptrs.size()));
+            const std::span<uint8_t> masks_span(masks.mutable_data(), ptrs.size());
+            {
+                py::gil_scoped_release release;
+                cw::write_action_masks(ptrs, masks_span);
+            }
+            return masks;
+        },
+        py::arg("states"));
+
+    m.def(
+        "states_to_bytes",
+        [](const std::vector<T> &states) {
+            std::vector<uint8_t> bytes;
+            {
+                py::gil_scoped_release release;
+                bytes = cw::states_to_bytes(states);
+            }
+            return py::bytes(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        },
+        py::arg("states"));
+    m.def(
+        "states_from_bytes",
+        [](const py::bytes &bytes) {
+            const auto data = bytes_view(bytes);
+            py::gil_scoped_release release;
+            return cw::states_from_bytes(data);
+        },
+        py::arg("data"));
+
+    m.attr("kUnreachable") = cw::kUnreachable;
+    py::class_<cw::DistanceCache>(m, "DistanceCache")
+        .def(py::init<>())
+        .def("distance_to_nearest", &cw::DistanceCache::distance_to_nearest, py::arg("state"), py::arg("element"))
+        .def(
+            "get_distance_field",
+            [](cw::DistanceCache &self, const T &state, cw::Element element) {
+                const auto field = self.get_distance_field(state, element);
+                const auto [rows, cols] = state.get_board_shape();
+                py::array_t<int> out({rows, cols});
+                std::copy(field.begin(), field.end(), out.mutable_data());
+                return out;
+            },
+            py::arg("state"), py::arg("element"))
+        .def("clear", &cw::DistanceCache::clear);
+
+    m.def(
+        "load_levels",
+        [](const std::string &path, int num_threads) {
+            py::gil_scoped_release release;
+            return cw::load_levels(path, num_threads);
+        },
+        py::arg("path"), py::arg("num_threads") = 1);
+
+    m.def(
+        "write_level_pack",
+        [](const std::string &path, const std::vector<T> &states) {
+            py::gil_scoped_release release;
+            cw::write_level_pack(path, states);
+        },
+        py::arg("path"), py::arg("states"));
+    py::class_<cw::LevelPack>(m, "LevelPack")
+        .def(py::init<const std::string &>(), py::arg("path"))
+        .def("__len__", &cw::LevelPack::size)
+        .def("__getitem__", &cw::LevelPack::get, py::arg("level_idx"))
+        .def("get", &cw::LevelPack::get, py::arg("level_idx"));
+
+    py::class_<cw::TrajectoryRecorder>(m, "TrajectoryRecorder")
+        .def(py::init<const std::string &, const T &, int>(), py::arg("path"), py::arg("initial_state"),
+             py::arg("checkpoint_interval") = cw::kDefaultCheckpointInterval)
+        .def(
+            "record",
+            [](cw::TrajectoryRecorder &self, int action) {
+                if (action < 0 || action >= T::action_space_size()) {
+                    throw std::invalid_argument("Invalid action.");
+                }
+                self.record(static_cast<cw::Action>(action));
+            },
+            py::arg("action"))
+        .def("state", &cw::TrajectoryRecorder::state, py::return_value_policy::copy)
+        .def("num_steps", &cw::TrajectoryRecorder::num_steps)
+        .def("finish", &cw::TrajectoryRecorder::finish);
+    py::class_<cw::TrajectoryReplayer>(m, "TrajectoryReplayer")
+        .def(py::init<const std::string &>(), py::arg("path"))
+        .def("num_steps", &cw::TrajectoryReplayer::num_steps)
+        .def("checkpoint_interval", &cw::TrajectoryReplayer::checkpoint_interval)
+        .def("actions",
+             [](const cw::TrajectoryReplayer &self) {
+                 const auto actions = self.actions();
+                 return std::vector<int>(actions.begin(), actions.end());
+             })
+        .def("seek", &cw::TrajectoryReplayer::seek, py::arg("step"))
+        .def("step", &cw::TrajectoryReplayer::step)
+        .def("current_step", &cw::TrajectoryReplayer::current_step)
+        .def("state", &cw::TrajectoryReplayer::state, py::return_value_policy::copy)
+        .def(
+            "get_observations",
+            [](cw::TrajectoryReplayer &self, std::size_t begin, std::size_t end) {
+                const auto [c, h, w] = self.state().observation_shape();
+                const auto n = static_cast<py::ssize_t>(end >= begin ? end - begin : 0);
+                py::array_t<float> obs({n, static_cast<py::ssize_t>(c), static_cast<py::ssize_t>(h),
+                                        static_cast<py::ssize_t>(w)});
+                const std::span<float> obs_span(obs.mutable_data(), static_cast<std::size_t>(obs.size()));
+                {
+                    py::gil_scoped_release release;
+                    self.write_observations(begin, end, obs_span);
+                }
+                return obs;
+            },
+            py::arg("begin"), py::arg("end"))
+        .def(
+            "get_images",
+            [](cw::TrajectoryReplayer &self, std::size_t begin, std::size_t end, int tile_size) {
+                const auto [h, w, c] = self.state().image_shape(tile_size);
+                const auto n = static_cast<py::ssize_t>(end >= begin ? end - begin : 0);
+                py::array_t<uint8_t> imgs({n, static_cast<py::ssize_t>(h), static_cast<py::ssize_t>(w),
+                                           static_cast<py::ssize_t>(c)});
+                const std::span<uint8_t> imgs_span(imgs.mutable_data(), static_cast<std::size_t>(imgs.size()));
+                {
+                    py::gil_scoped_release release;
+                    self.write_images(begin, end, imgs_span, tile_size);
+                }
+                return imgs;
+            },
+            py::arg("begin"), py::arg("end"), py::arg("tile_size") = cw::SPRITE_WIDTH);
+
+    py::class_<cw::GeneratorOptions>(m, "GeneratorOptions")
+        .def(py::init<>())
+        .def_readwrite("map_size", &cw::GeneratorOptions::map_size)
+        .def_readwrite("goal_probs", &cw::GeneratorOptions::goal_probs)
+        .def_readwrite("hard", &cw::GeneratorOptions::hard)
+        .def_readwrite("num_primitive", &cw::GeneratorOptions::num_primitive)
+        .def_readwrite("num_grass", &cw::GeneratorOptions::num_grass)
+        .def_readwrite("require_solvable", &cw::GeneratorOptions::require_solvable)
+        .def_readwrite("solver_max_expansions", &cw::GeneratorOptions::solver_max_expansions);
+    m.attr("kGoalProbsTrain") = cw::kGoalProbsTrain;
+    m.attr("kGoalProbsTrainHard") = cw::kGoalProbsTrainHard;
+    m.attr("kGoalProbsTest") = cw::kGoalProbsTest;
+    m.attr("kGoalProbsTestHard") = cw::kGoalProbsTestHard;
+    m.def(
+        "generate_board_strs",
+        [](const cw::GeneratorOptions &options, int num_levels, uint64_t seed, int num_threads) {
+            py::gil_scoped_release release;
+            return cw::generate_board_strs(options, num_levels, seed, num_threads);
+        },
+        py::arg("options"), py::arg("num_levels"), py::arg("seed") = 0, py::arg("num_threads") = 1);
+    m.def(
+        "generate_levels",
+        [](const cw::GeneratorOptions &options, int num_levels, uint64_t seed, int num_threads) {
+            py::gil_scoped_release release;
+            return cw::generate_levels(options, num_levels, seed, num_threads);
+        },
+        py::arg("options"), py::arg("num_levels"), py::arg("seed") = 0, py::arg("num_threads") = 1);
+
+    py::enum_<cw::SearchAlgorithm>(m, "SearchAlgorithm")
+        .value("kBFS", cw::SearchAlgorithm::kBFS)
+        .value("kAStar", cw::SearchAlgorithm::kAStar);
+    py::enum_<cw::SolverStatus>(m, "SolverStatus")
+        .value("kSolved", cw::SolverStatus::kSolved)
+        .value("kUnsolvable", cw::SolverStatus::kUnsolvable)
+        .value("kLimitReached", cw::SolverStatus::kLimitReached);
+    py::class_<cw::SolverResult>(m, "SolverResult")
+        .def_readonly("status", &cw::SolverResult::status)
+        .def_property_readonly("actions",
+                               [](const cw::SolverResult &self) {
+                                   return std::vector<int>(self.actions.begin(), self.actions.end());
+                               })
+        .def_readonly("expanded", &cw::SolverResult::expanded)
+        .def_readonly("generated", &cw::SolverResult::generated);
+    m.def(
+        "solve",
+        [](const T &state, cw::SearchAlgorithm algorithm, int64_t max_expansions) {
+            py::gil_scoped_release release;
+            return cw::solve(state, {.algorithm = algorithm, .max_expansions = max_expansions});
+        },
+        py::arg("state"), py::arg("algorithm") = cw::SearchAlgorithm::kBFS, py::arg("max_expansions") = 0);
+    m.def(
+        "solve_all",
+        [](const std::vector<T> &states, cw::SearchAlgorithm algorithm, int64_t max_expansions, int num_threads) {
+            py::gil_scoped_release release;
+            return cw::solve_all(states, {.algorithm = algorithm, .max_expansions = max_expansions}, num_threads);
+        },
+        py::arg("states"), py::arg("algorithm") = cw::SearchAlgorithm::kBFS, py::arg("max_expansions") = 0,
+        py::arg("num_threads") = 1);
+
+    py::enum_<cw::RolloutPolicy>(m, "RolloutPolicy")
+        .value("kUniform", cw::RolloutPolicy::kUniform)
+        .value("kMaskedUniform", cw::RolloutPolicy::kMaskedUniform)
+        .value("kCallback", cw::RolloutPolicy::kCallback);
+    py::class_<cw::RolloutStats>(m, "RolloutStats")
+        .def_readonly("num_rollouts", &cw::RolloutStats::num_rollouts)
+        .def_readonly("num_solved", &cw::RolloutStats::num_solved)
+        .def_readonly("total_steps", &cw::RolloutStats::total_steps)
+        .def_readonly("solved_fraction", &cw::RolloutStats::solved_fraction)
+        .def_readonly("mean_steps_to_solve", &cw::RolloutStats::mean_steps_to_solve)
+        .def_readonly("reward_bit_counts", &cw::RolloutStats::reward_bit_counts)
+        .def_readonly("reward_bit_frequencies", &cw::RolloutStats::reward_bit_frequencies);
+    py::class_<cw::RolloutEngine>(m, "RolloutEngine")
+        .def(py::init<int>(), py::arg("num_threads") = 1)
+        .def("num_threads", &cw::RolloutEngine::num_threads)
+        .def(
+            "run",
+            [](cw::RolloutEngine &self, const T &state, int num_rollouts, int max_depth, cw::RolloutPolicy policy,
+               uint64_t seed, const std::optional<py::function> &callback) {
+                cw::RolloutOptions options{
+                    .num_rollouts = num_rollouts, .max_depth = max_depth, .policy = policy, .seed = seed};
+                if (callback) {
+                    // Called from the engine threads, which take turns holding the GIL
+                    options.policy = cw::RolloutPolicy::kCallback;
+                    options.callback = [callback = *callback](const T &rollout_state, std::mt19937_64 &) {
+                        py::gil_scoped_acquire acquire;
+                        return static_cast<cw::Action>(callback(rollout_state).cast<int>());
+                    };
+                }
+                py::gil_scoped_release release;
+                return self.run(state, options);
+            },
+            py::arg("state"), py::arg("num_rollouts"), py::arg("max_depth") = 100,
+            py::arg("policy") = cw::RolloutPolicy::kUniform, py::arg("seed") = 0, py::arg("callback") = py::none());
+
+    using VecT = cw::CraftWorldVecEnv;
+    py::class_<VecT>(m, "CraftWorldVecEnv")
+        .def(py::init<const std::vector<std::string> &, int, int, uint64_t>(), py::arg("board_strs"),
+             py::arg("num_envs"), py::arg("num_threads") = 1, py::arg("seed") = 0)
+        .def("num_envs", &VecT::num_envs)
+        .def("observation_shape", &VecT::observation_shape)
+        .def("get_state", &VecT::get_state, py::return_value_policy::copy)
+        .def("action_masks",
+             [](const VecT &self) {
+                 return make_view(self.action_masks().data(), {self.num_envs()}, py::cast(&self));
+             })
+        .def("reset",
+             [](VecT &self) {
+                 {
+                     py::gil_scoped_release release;
+                     self.reset();
+                 }
+                 const auto [c, h, w] = self.observation_shape();
+                 return make_view(self.observations().data(), {self.num_envs(), c, h, w}, py::cast(&self));
+             })
+        .def("step", [](VecT &self, const py::array_t<int, py::array::c_style | py::array::forcecast> &actions) {
+            {
+                py::gil_scoped_release release;
+                self.step({actions.data(), static_cast<std::size_t>(actions.size())});
+            }
+            const auto [c, h, w] = self.observation_shape();
+            const auto base = py::cast(&self);
+            return py::make_tuple(
+                make_view(self.observations().data(), {self.num_envs(), c, h, w}, base),
+                make_view(self.reward_signals().data(), {self.num_envs()}, base),
+                make_view(reinterpret_cast<const bool *>(self.dones().data()), {self.num_envs()}, base));
+        });
+
+    m.attr("kInstrumentation") = cw::kInstrumentation;
+    m.def("get_instrumentation", []() {
+        const auto snapshot = cw::get_instrumentation();
+        py::dict counters;
+        for (std::size_t i = 0; i < cw::kNumCounters; ++i) {
+            counters[py::str(cw::counter_name(static_cast<cw::Counter>(i)))] = snapshot.counters[i];
+        }
+        py::dict timers;
+        for (std::size_t i = 0; i < cw::kNumTimers; ++i) {
+            timers[py::str(cw::timer_name(static_cast<cw::Timer>(i)))] =
+                py::make_tuple(snapshot.timer_calls[i], snapshot.timer_ns[i]);
+        }
+        py::dict result;
+        result["counters"] = counters;
+        result["timers"] = timers;
+        return result;
+    });
+    m.def("reset_instrumentation", &cw::reset_instrumentation);
 }
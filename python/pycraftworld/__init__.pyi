@@ -1,4 +1,4 @@
-from typing import ClassVar
+from typing import Callable, ClassVar
 
 import numpy
 from numpy.typing import NDArray
@@ -81,6 +81,8 @@ class RewardCode:
     @property
     def value(self) -> int: ...
 
+class UndoRecord: ...
+
 class CraftWorldGameState:
     name: ClassVar[str] = ...  # read-only
     num_actions: ClassVar[int] = ...  # read-only
@@ -90,14 +92,278 @@ class CraftWorldGameState:
     def __eq__(self, other: object) -> bool: ...
     def __hash__(self) -> int: ...
     def __ne__(self, other: object) -> bool: ...
+    # Versioned binary encoding, also used for pickling
+    def to_bytes(self) -> bytes: ...
+    @staticmethod
+    def from_bytes(data: bytes) -> CraftWorldGameState: ...
     def apply_action(self, int: int) -> None: ...
+    def apply_action_with_undo(self, action: int) -> UndoRecord: ...
+    # Records must be undone in reverse order of being applied
+    def undo(self, record: UndoRecord) -> None: ...
+    # Bit i is set if action i would change the state
+    def effective_action_mask(self) -> int: ...
     def is_solution(self) -> bool: ...
     def observation_shape(self) -> tuple[int, int, int]: ...
     def get_observation(self) -> NDArray[numpy.float32]: ...
-    def image_shape(self) -> tuple[int, int, int]: ...
-    def to_image(self) -> NDArray[numpy.uint8]: ...
+    def write_observation(self, out: NDArray[numpy.float32]) -> None: ...
+    # out must hold this state's observation from before the last apply_action
+    def update_observation(self, out: NDArray[numpy.float32]) -> None: ...
+    def get_observation_uint8(self) -> NDArray[numpy.uint8]: ...
+    def write_observation_uint8(self, out: NDArray[numpy.uint8]) -> None: ...
+    def packed_observation_size(self) -> int: ...
+    def get_observation_packed(self) -> NDArray[numpy.uint8]: ...
+    def write_observation_packed(self, out: NDArray[numpy.uint8]) -> None: ...
+    # Agent-centred window of the board, walls outside it, without the inventory
+    @staticmethod
+    def egocentric_observation_shape(radius: int) -> tuple[int, int, int]: ...
+    def get_egocentric_observation(self, radius: int) -> NDArray[numpy.float32]: ...
+    def write_egocentric_observation(self, out: NDArray[numpy.float32], radius: int) -> None: ...
+    # Inventory slots of the observation border, kInventoryObservationSize values
+    def get_inventory_observation(self) -> NDArray[numpy.float32]: ...
+    def write_inventory_observation(self, out: NDArray[numpy.float32]) -> None: ...
+    def image_shape(self, tile_size: int = 32) -> tuple[int, int, int]: ...
+    def to_image(self, tile_size: int = 32) -> NDArray[numpy.uint8]: ...
+    def write_image(self, out: NDArray[numpy.uint8], tile_size: int = 32) -> None: ...
     def get_reward_signal(self) -> int: ...
+    def get_hash(self) -> int: ...
+    # (low, high) words, the low word is get_hash()
+    def get_hash128(self) -> tuple[int, int]: ...
     def get_agent_index(self) -> int: ...
+    def get_goal(self) -> Element: ...
+    def get_board_shape(self) -> tuple[int, int]: ...
+    def get_element(self, index: int) -> Element: ...
     def get_indices(self, element: Element) -> list[int]: ...
     def add_to_inventory(self, element: Element, count: int) -> None: ...
     def check_inventory(self, element: Element) -> bool: ...
+
+class CraftWorldRenderer:
+    def __init__(self, tile_size: int = 32) -> None: ...
+    def image_shape(self) -> tuple[int, int, int]: ...
+    def tile_size(self) -> int: ...
+    def reset(self) -> None: ...
+    # Returned frame is a view overwritten by the next render
+    def render(self, state: CraftWorldGameState) -> NDArray[numpy.uint8]: ...
+
+# Expand (..., packed_size) bit-packed observations to float32 (..., C, H, W)
+def unpack_observations(
+    packed: NDArray[numpy.uint8], obs_shape: tuple[int, int, int]
+) -> NDArray[numpy.float32]: ...
+
+# Batched calls over states of the same rows/cols, run without holding the GIL.
+# step_states steps each state in place and returns (observations, reward_signals, solved)
+def step_states(
+    states: list[CraftWorldGameState], actions: NDArray[numpy.int32]
+) -> tuple[NDArray[numpy.float32], NDArray[numpy.uint64], NDArray[numpy.bool_]]: ...
+def get_observations(states: list[CraftWorldGameState]) -> NDArray[numpy.float32]: ...
+kInventoryObservationSize: int
+
+# (observations, inventories) of shapes (N, C, 2*radius+1, 2*radius+1) and (N, kInventoryObservationSize),
+# states may have different rows/cols
+def get_egocentric_observations(
+    states: list[CraftWorldGameState], radius: int
+) -> tuple[NDArray[numpy.float32], NDArray[numpy.float32]]: ...
+def get_images(states: list[CraftWorldGameState], tile_size: int = 32) -> NDArray[numpy.uint8]: ...
+def get_action_masks(states: list[CraftWorldGameState]) -> NDArray[numpy.uint8]: ...
+
+# Many states encoded into one buffer
+def states_to_bytes(states: list[CraftWorldGameState]) -> bytes: ...
+def states_from_bytes(data: bytes) -> list[CraftWorldGameState]: ...
+
+kUnreachable: int
+
+# Distance fields per target element, rebuilt only when the board changes. Not thread safe.
+class DistanceCache:
+    def __init__(self) -> None: ...
+    # Moves to stand beside the nearest element, kUnreachable if none can be reached
+    def distance_to_nearest(self, state: CraftWorldGameState, element: Element) -> int: ...
+    def get_distance_field(self, state: CraftWorldGameState, element: Element) -> NDArray[numpy.int32]: ...
+    def clear(self) -> None: ...
+
+# One state per non-blank line of a problems file, errors name the line number
+def load_levels(path: str, num_threads: int = 1) -> list[CraftWorldGameState]: ...
+
+# Levels must have an empty inventory, only the board and goal are stored
+def write_level_pack(path: str, states: list[CraftWorldGameState]) -> None: ...
+
+# Memory mapped level pack, levels are built on access
+class LevelPack:
+    def __init__(self, path: str) -> None: ...
+    def __len__(self) -> int: ...
+    def __getitem__(self, level_idx: int) -> CraftWorldGameState: ...
+    def get(self, level_idx: int) -> CraftWorldGameState: ...
+
+# Streams the initial level, 3 bits per action and a checkpoint every checkpoint_interval actions to a file
+class TrajectoryRecorder:
+    def __init__(
+        self, path: str, initial_state: CraftWorldGameState, checkpoint_interval: int = 64
+    ) -> None: ...
+    # Applies the action to the recorded state
+    def record(self, action: int) -> None: ...
+    def state(self) -> CraftWorldGameState: ...
+    def num_steps(self) -> int: ...
+    def finish(self) -> None: ...
+
+# Step s is the state after the first s actions, for s in [0, num_steps()]
+class TrajectoryReplayer:
+    def __init__(self, path: str) -> None: ...
+    def num_steps(self) -> int: ...
+    def checkpoint_interval(self) -> int: ...
+    def actions(self) -> list[int]: ...
+    def seek(self, step: int) -> None: ...
+    # False if already at the last step
+    def step(self) -> bool: ...
+    def current_step(self) -> int: ...
+    def state(self) -> CraftWorldGameState: ...
+    # States at steps [begin, end), leaving the replayer at end - 1
+    def get_observations(self, begin: int, end: int) -> NDArray[numpy.float32]: ...
+    def get_images(self, begin: int, end: int, tile_size: int = 32) -> NDArray[numpy.uint8]: ...
+
+class GeneratorOptions:
+    map_size: int
+    # Probability of each goal: BronzePick, IronPick, GemRing
+    goal_probs: list[float]
+    hard: bool
+    num_primitive: int
+    num_grass: int
+    require_solvable: bool
+    solver_max_expansions: int
+    def __init__(self) -> None: ...
+
+kGoalProbsTrain: list[float]
+kGoalProbsTrainHard: list[float]
+kGoalProbsTest: list[float]
+kGoalProbsTestHard: list[float]
+
+# Level i is generated from seed + i, independent of num_threads
+def generate_board_strs(
+    options: GeneratorOptions, num_levels: int, seed: int = 0, num_threads: int = 1
+) -> list[str]: ...
+def generate_levels(
+    options: GeneratorOptions, num_levels: int, seed: int = 0, num_threads: int = 1
+) -> list[CraftWorldGameState]: ...
+
+class SearchAlgorithm:
+    __members__: ClassVar[dict] = ...  # read-only
+    __entries: ClassVar[dict] = ...
+    kAStar: ClassVar[SearchAlgorithm] = ...
+    kBFS: ClassVar[SearchAlgorithm] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+class SolverStatus:
+    __members__: ClassVar[dict] = ...  # read-only
+    __entries: ClassVar[dict] = ...
+    kLimitReached: ClassVar[SolverStatus] = ...
+    kSolved: ClassVar[SolverStatus] = ...
+    kUnsolvable: ClassVar[SolverStatus] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+class SolverResult:
+    @property
+    def status(self) -> SolverStatus: ...
+    @property
+    def actions(self) -> list[int]: ...
+    @property
+    def expanded(self) -> int: ...
+    @property
+    def generated(self) -> int: ...
+
+# Shortest plan to the goal, max_expansions of 0 for no limit
+def solve(
+    state: CraftWorldGameState, algorithm: SearchAlgorithm = ..., max_expansions: int = 0
+) -> SolverResult: ...
+def solve_all(
+    states: list[CraftWorldGameState],
+    algorithm: SearchAlgorithm = ...,
+    max_expansions: int = 0,
+    num_threads: int = 1,
+) -> list[SolverResult]: ...
+
+class RolloutPolicy:
+    __members__: ClassVar[dict] = ...  # read-only
+    __entries: ClassVar[dict] = ...
+    kCallback: ClassVar[RolloutPolicy] = ...
+    kMaskedUniform: ClassVar[RolloutPolicy] = ...
+    kUniform: ClassVar[RolloutPolicy] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+class RolloutStats:
+    @property
+    def num_rollouts(self) -> int: ...
+    @property
+    def num_solved(self) -> int: ...
+    @property
+    def total_steps(self) -> int: ...
+    @property
+    def solved_fraction(self) -> float: ...
+    # Mean actions taken by solved rollouts, 0 if none solved
+    @property
+    def mean_steps_to_solve(self) -> float: ...
+    # Rollouts in which each of the 64 reward signal bits was set, and that count over num_rollouts
+    @property
+    def reward_bit_counts(self) -> list[int]: ...
+    @property
+    def reward_bit_frequencies(self) -> list[float]: ...
+
+class RolloutEngine:
+    def __init__(self, num_threads: int = 1) -> None: ...
+    def num_threads(self) -> int: ...
+    # Rollout i is seeded from (seed, i), independent of num_threads.
+    # A callback taking the state and returning an action sets the policy to kCallback, and holds the GIL.
+    def run(
+        self,
+        state: CraftWorldGameState,
+        num_rollouts: int,
+        max_depth: int = 100,
+        policy: RolloutPolicy = ...,
+        seed: int = 0,
+        callback: Callable[[CraftWorldGameState], int] | None = None,
+    ) -> RolloutStats: ...
+
+class CraftWorldVecEnv:
+    def __init__(
+        self, board_strs: list[str], num_envs: int, num_threads: int = 1, seed: int = 0
+    ) -> None: ...
+    def num_envs(self) -> int: ...
+    def observation_shape(self) -> tuple[int, int, int]: ...
+    def get_state(self, env_idx: int) -> CraftWorldGameState: ...
+    # effective_action_mask() of each environment, a view updated by reset/step
+    def action_masks(self) -> NDArray[numpy.uint8]: ...
+    # Returned arrays are views into buffers overwritten by the next reset/step
+    def reset(self) -> NDArray[numpy.float32]: ...
+    def step(
+        self, actions: NDArray[numpy.int32]
+    ) -> tuple[NDArray[numpy.float32], NDArray[numpy.uint64], NDArray[numpy.bool_]]: ...
+
+# Always False and get_instrumentation() all zero unless built with CRAFTWORLD_INSTRUMENTATION
+kInstrumentation: bool
+
+# {"counters": {name: count}, "timers": {name: (calls, total_ns)}} since the last reset, across all threads
+def get_instrumentation() -> dict[str, dict]: ...
+def reset_instrumentation() -> None: ...
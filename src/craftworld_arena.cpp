@@ -0,0 +1,165 @@
+#include "craftworld_arena.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace craftworld {
+
+namespace {
+// Slot layout, with the fixed fields first so they stay aligned:
+//   0: uint64 hash, uint64 hash_hi, uint64 board_hash, uint64 reward_signal
+//  32: int32 agent index, then int32 inventory count per element
+//  then rows * cols uint8 cells in row-major order, padded to a multiple of 8 bytes
+constexpr std::size_t kSlotHashOffset = 0;
+constexpr std::size_t kSlotHashHiOffset = 8;
+constexpr std::size_t kSlotBoardHashOffset = 16;
+constexpr std::size_t kSlotRewardOffset = 24;
+constexpr std::size_t kSlotAgentOffset = 32;
+constexpr std::size_t kSlotInventoryOffset = 36;
+constexpr std::size_t kSlotInventorySize = sizeof(int) * kNumElements;
+constexpr std::size_t kSlotCellsOffset = kSlotInventoryOffset + kSlotInventorySize;
+constexpr std::size_t kSlotAlign = 8;
+// Target size of each slab, rounded down to a power of 2 slots
+constexpr std::size_t kSlabBytes = std::size_t{1} << 20;
+
+template <typename T>
+void write_field(uint8_t *slot, std::size_t offset, const T &value) noexcept {
+    std::memcpy(slot + offset, &value, sizeof(T));
+}
+
+template <typename T>
+auto read_field(const uint8_t *slot, std::size_t offset) noexcept -> T {
+    T value;
+    std::memcpy(&value, slot + offset, sizeof(T));
+    return value;
+}
+}    // namespace
+
+StateArena::StateArena(const CraftWorldGameState &_level)
+    : level(_level),
+      num_cells(static_cast<std::size_t>(level.rows * level.cols)),
+      stride((kSlotCellsOffset + num_cells + kSlotAlign - 1) / kSlotAlign * kSlotAlign),
+      slab_shift(static_cast<std::size_t>(std::bit_width(std::max<std::size_t>(1, kSlabBytes / stride)) - 1)) {}
+
+auto StateArena::add(const CraftWorldGameState &state) -> StateHandle {
+    const auto handle = NewSlot();
+    store(handle, state);
+    return handle;
+}
+
+auto StateArena::clone(StateHandle parent) -> StateHandle {
+    const auto handle = NewSlot();
+    std::memcpy(Slot(handle), Slot(parent), stride);
+    return handle;
+}
+
+void StateArena::store(StateHandle handle, const CraftWorldGameState &state) {
+    if (state.rows != level.rows || state.cols != level.cols || state.goal != level.goal) {
+        throw std::invalid_argument("State is not of the arena level.");
+    }
+    uint8_t *slot = Slot(handle);
+    write_field(slot, kSlotHashOffset, state.hash);
+    write_field(slot, kSlotHashHiOffset, state.hash_hi);
+    write_field(slot, kSlotBoardHashOffset, state.board_hash);
+    write_field(slot, kSlotRewardOffset, state.reward_signal);
+    write_field(slot, kSlotAgentOffset, state.agent_idx);
+    std::memcpy(slot + kSlotInventoryOffset, state.inventory.data(), kSlotInventorySize);
+    const auto cols = static_cast<std::size_t>(level.cols);
+    for (int r = 0; r < level.rows; ++r) {
+        std::memcpy(slot + kSlotCellsOffset + static_cast<std::size_t>(r) * cols,
+                    state.grid.data() + (r + 1) * level.padded_cols + 1, cols);
+    }
+}
+
+void StateArena::load(StateHandle handle, CraftWorldGameState &out) const {
+    // The walls and board size only need setting when out is from another level
+    if (out.rows != level.rows || out.cols != level.cols || out.goal != level.goal) {
+        out = level;
+    }
+    const uint8_t *slot = Slot(handle);
+    out.hash = read_field<uint64_t>(slot, kSlotHashOffset);
+    out.hash_hi = read_field<uint64_t>(slot, kSlotHashHiOffset);
+    out.board_hash = read_field<uint64_t>(slot, kSlotBoardHashOffset);
+    out.reward_signal = read_field<uint64_t>(slot, kSlotRewardOffset);
+    out.agent_idx = read_field<int>(slot, kSlotAgentOffset);
+    out.agent_padded_idx = out.ToPaddedIndex(out.agent_idx);
+    std::memcpy(out.inventory.data(), slot + kSlotInventoryOffset, kSlotInventorySize);
+    const auto cols = static_cast<std::size_t>(level.cols);
+    for (int r = 0; r < level.rows; ++r) {
+        std::memcpy(out.grid.data() + (r + 1) * level.padded_cols + 1,
+                    slot + kSlotCellsOffset + static_cast<std::size_t>(r) * cols, cols);
+    }
+    out.delta = {};
+}
+
+auto StateArena::get(StateHandle handle) const -> CraftWorldGameState {
+    CraftWorldGameState state = level;
+    load(handle, state);
+    return state;
+}
+
+auto StateArena::get_hash(StateHandle handle) const noexcept -> uint64_t {
+    return read_field<uint64_t>(Slot(handle), kSlotHashOffset);
+}
+
+auto StateArena::equals(StateHandle handle, const CraftWorldGameState &state) const noexcept -> bool {
+    if (state.rows != level.rows || state.cols != level.cols || state.goal != level.goal) {
+        return false;
+    }
+    const uint8_t *slot = Slot(handle);
+    if (read_field<int>(slot, kSlotAgentOffset) != state.agent_idx ||
+        std::memcmp(slot + kSlotInventoryOffset, state.inventory.data(), kSlotInventorySize) != 0) {
+        return false;
+    }
+    const auto cols = static_cast<std::size_t>(level.cols);
+    for (int r = 0; r < level.rows; ++r) {
+        if (std::memcmp(slot + kSlotCellsOffset + static_cast<std::size_t>(r) * cols,
+                        state.grid.data() + (r + 1) * level.padded_cols + 1, cols) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto StateArena::size() const noexcept -> std::size_t {
+    return num_slots;
+}
+
+auto StateArena::slot_size() const noexcept -> std::size_t {
+    return stride;
+}
+
+auto StateArena::memory_usage() const noexcept -> std::size_t {
+    return slabs.size() * (stride << slab_shift);
+}
+
+void StateArena::clear() noexcept {
+    slabs.clear();
+    slabs.shrink_to_fit();
+    num_slots = 0;
+}
+
+auto StateArena::NewSlot() -> StateHandle {
+    if (num_slots > std::numeric_limits<StateHandle>::max()) {
+        throw std::runtime_error("State arena is full.");
+    }
+    if ((num_slots >> slab_shift) == slabs.size()) {
+        slabs.push_back(std::make_unique_for_overwrite<uint8_t[]>(stride << slab_shift));
+    }
+    return static_cast<StateHandle>(num_slots++);
+}
+
+auto StateArena::Slot(StateHandle handle) noexcept -> uint8_t * {
+    const auto mask = (std::size_t{1} << slab_shift) - 1;
+    return slabs[handle >> slab_shift].get() + (handle & mask) * stride;
+}
+
+auto StateArena::Slot(StateHandle handle) const noexcept -> const uint8_t * {
+    const auto mask = (std::size_t{1} << slab_shift) - 1;
+    return slabs[handle >> slab_shift].get() + (handle & mask) * stride;
+}
+
+}    // namespace craftworld
@@ -0,0 +1,116 @@
+#ifndef CRAFTWORLD_ARENA_H_
+#define CRAFTWORLD_ARENA_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+// Index of a state stored in a StateArena, stable for the life of the arena
+using StateHandle = uint32_t;
+
+// Compact storage for many states of one level, such as the nodes of a search.
+// Every state reachable in a level has the same rows/cols and goal, so each is stored in a fixed-stride slot
+// holding only the hash, reward signal, agent index, inventory and unpadded cells.
+// Slots live in fixed-size slabs which are never moved, and are all freed together by clear().
+class StateArena {
+public:
+    /**
+     * Create an empty arena for states of a level.
+     * @param level Any state of the level, which sets the rows/cols and goal of every stored state
+     */
+    explicit StateArena(const CraftWorldGameState &level);
+
+    /**
+     * Store a copy of a state in a new slot.
+     * @param state State of the arena level
+     * @return Handle to the new slot
+     */
+    auto add(const CraftWorldGameState &state) -> StateHandle;
+
+    /**
+     * Copy a stored state into a new slot, to be overwritten with store() once a child is built.
+     * @param parent Handle of the state to copy
+     * @return Handle to the new slot
+     */
+    auto clone(StateHandle parent) -> StateHandle;
+
+    /**
+     * Overwrite the state in a slot.
+     * @param handle Slot to overwrite
+     * @param state State of the arena level
+     */
+    void store(StateHandle handle, const CraftWorldGameState &state);
+
+    /**
+     * Rebuild a stored state into an existing state, without allocating.
+     * The rebuilt state has no last action, so update_observation() needs a write_observation() first.
+     * @param handle Slot to read
+     * @param out State to overwrite, cheapest when already a state of the arena level
+     */
+    void load(StateHandle handle, CraftWorldGameState &out) const;
+
+    /**
+     * Rebuild a stored state.
+     * @param handle Slot to read
+     * @return Stored state
+     */
+    [[nodiscard]] auto get(StateHandle handle) const -> CraftWorldGameState;
+
+    /**
+     * Get the hash of a stored state, without rebuilding it.
+     * @param handle Slot to read
+     * @return get_hash() of the stored state
+     */
+    [[nodiscard]] auto get_hash(StateHandle handle) const noexcept -> uint64_t;
+
+    /**
+     * Check if a stored state is equal to a state, as operator== does, without rebuilding it.
+     * @param handle Slot to read
+     * @param state State to compare against
+     * @return True if equal, false otherwise
+     */
+    [[nodiscard]] auto equals(StateHandle handle, const CraftWorldGameState &state) const noexcept -> bool;
+
+    /**
+     * Get the number of stored states.
+     * @return Count of slots handed out
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /**
+     * Get the bytes used by each slot.
+     * @return Slot stride in bytes
+     */
+    [[nodiscard]] auto slot_size() const noexcept -> std::size_t;
+
+    /**
+     * Get the bytes allocated for slots, including unused slots of the last slab.
+     * @return Allocated bytes
+     */
+    [[nodiscard]] auto memory_usage() const noexcept -> std::size_t;
+
+    /**
+     * Free every slot at once, invalidating all handles.
+     */
+    void clear() noexcept;
+
+private:
+    auto NewSlot() -> StateHandle;
+    auto Slot(StateHandle handle) noexcept -> uint8_t *;
+    auto Slot(StateHandle handle) const noexcept -> const uint8_t *;
+
+    CraftWorldGameState level;    // Rebuilt states start as a copy, which sets the board size and walls
+    std::size_t num_cells;
+    std::size_t stride;
+    std::size_t slab_shift;       // Slots per slab is a power of 2, so handles split with a shift and mask
+    std::vector<std::unique_ptr<uint8_t[]>> slabs;
+    std::size_t num_slots = 0;
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_ARENA_H_
@@ -1,10 +1,17 @@
 
 #include "craftworld_base.h"
 
+#include <algorithm>
+#include <charconv>
 #include <cstdint>
-#include <sstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <type_traits>
 
+#include "craftworld_instrumentation.h"
+#include "craftworld_renderer.h"
 #include "definitions.h"
 
 namespace craftworld {
@@ -28,213 +35,728 @@ constexpr uint64_t SPLIT64_C1 = 0x9E3779B97f4A7C15;
 constexpr uint64_t SPLIT64_C2 = 0xBF58476D1CE4E5B9;
 constexpr uint64_t SPLIT64_C3 = 0x94D049BB133111EB;
 
+// Fixed part of the kStateBytesVersion encoding, before the inventory entries
+constexpr std::size_t kStateBytesHeaderSize = 17;
+constexpr std::size_t kStateBytesInventoryEntrySize = 5;
+// Rows/cols/goal are stored as single bytes
+static_assert(kMaxBoardDim <= std::numeric_limits<uint8_t>::max());
+
 template <class E>
 constexpr inline auto to_underlying(E e) noexcept -> std::underlying_type_t<E> {
     return static_cast<std::underlying_type_t<E>>(e);
 }
 
-auto to_local_hash(int flat_size, Element el, int offset) noexcept -> uint64_t {
-    uint64_t seed = (flat_size * to_underlying(el)) + offset;
+// Inventory items shown in the observation border, at a flat index into the border channel
+// The slot is filled once the inventory holds at least min_count of the element
+struct InventorySlot {
+    Element element;
+    int index;
+    int min_count;
+};
+constexpr std::array<InventorySlot, kInventoryObservationSize> kInventorySlots{{
+    {Element::kWood, 0, 1},
+    {Element::kWood, 1, 2},
+    {Element::kCopper, 2, 1},
+    {Element::kTin, 3, 1},
+    {Element::kIron, 4, 1},
+    {Element::kStick, 5, 1},
+    {Element::kStick, 6, 2},
+    {Element::kBronzeBar, 7, 1},
+    {Element::kBronzePick, 8, 1},
+    {Element::kIronPick, 9, 1},
+}};
+
+// Observation formats, each storing one value per (channel, cell) of the flat CHW observation
+template <typename T>
+struct DenseObservation {
+    std::span<T> data;
+    void clear() noexcept {
+        std::fill(data.begin(), data.end(), static_cast<T>(0));
+    }
+    void set(std::size_t idx, bool value) noexcept {
+        data[idx] = static_cast<T>(value);
+    }
+};
+
+// One bit per value, bit i of the flat observation is bit (i % 8) of byte (i / 8)
+struct PackedObservation {
+    std::span<uint8_t> data;
+    void clear() noexcept {
+        std::fill(data.begin(), data.end(), static_cast<uint8_t>(0));
+    }
+    void set(std::size_t idx, bool value) noexcept {
+        const auto mask = static_cast<uint8_t>(1U << (idx & 7U));
+        data[idx >> 3U] = value ? (data[idx >> 3U] | mask) : (data[idx >> 3U] & ~mask);
+    }
+};
+
+template <typename ObsT>
+void write_inventory_slot(ObsT &obs, int cols_obs, int channel_length, const InventorySlot &slot, int count) {
+    const auto idx = static_cast<std::size_t>(slot.index);
+    const auto el_offset = static_cast<std::size_t>(slot.element) * channel_length;
+    const auto empty_offset = static_cast<std::size_t>(Element::kEmpty) * channel_length;
+    if (count >= slot.min_count) {
+        obs.set(el_offset + idx, true);
+        obs.set(empty_offset + idx, false);
+    } else {
+        // Restore the border, slots wrap past the first row on narrow boards
+        const int col = slot.index % cols_obs;
+        const bool is_outer = slot.index < cols_obs || col == 0 || col == cols_obs - 1;
+        obs.set(el_offset + idx, false);
+        obs.set(empty_offset + idx, is_outer);
+    }
+}
+
+auto splitmix64(uint64_t seed) noexcept -> uint64_t {
     uint64_t result = seed + SPLIT64_C1;
     result = (result ^ (result >> SPLIT64_S1)) * SPLIT64_C2;
     result = (result ^ (result >> SPLIT64_S2)) * SPLIT64_C3;
     return result ^ (result >> SPLIT64_S3);
 }
 
+// Seeds of the high hash word are offset far past any seed of the low word
+constexpr uint64_t kHashHiSeedOffset = 0xD1B54A32D192ED03;
+
+auto to_local_hash(int flat_size, Element el, int offset) noexcept -> uint64_t {
+    return splitmix64((flat_size * to_underlying(el)) + offset);
+}
+
 auto to_local_inventory_hash(int flat_size, Element el, int count) noexcept -> uint64_t {
-    uint64_t seed = (flat_size * kNumElements) + (flat_size * to_underlying(el)) + count;    // NOLINT(*-magic-numbers)
-    uint64_t result = seed + SPLIT64_C1;
-    result = (result ^ (result >> SPLIT64_S1)) * SPLIT64_C2;
-    result = (result ^ (result >> SPLIT64_S2)) * SPLIT64_C3;
-    return result ^ (result >> SPLIT64_S3);
+    // NOLINTNEXTLINE(*-magic-numbers)
+    return splitmix64((flat_size * kNumElements) + (flat_size * to_underlying(el)) + count);
 }
+
+// Parse the integer segment of a board string starting at pos, and move pos past the following separator
+auto parse_board_value(std::string_view board_str, std::size_t &pos, int &value) noexcept -> bool {
+    const auto segment_end = std::min(board_str.find('|', pos), board_str.size());
+    const char *begin = board_str.data() + pos;
+    const char *end = board_str.data() + segment_end;
+    const auto [ptr, ec] = std::from_chars(begin, end, value);
+    pos = segment_end + 1;
+    return ec == std::errc() && ptr == end && begin != end;
+}
+
+// Inventory counts with a precomputed prefix key, larger counts extend the last prefix
+constexpr int kZobristInventoryCounts = 64;
 }    // namespace
 
-CraftWorldGameState::CraftWorldGameState(const std::string &board_str) {
-    std::stringstream board_ss(board_str);
-    std::string segment;
-    std::vector<std::string> seglist;
-    // string split on |
-    while (std::getline(board_ss, segment, '|')) {
-        seglist.push_back(segment);
+struct ZobristTable {
+    struct Key {
+        uint64_t lo;
+        uint64_t hi;
+    };
+
+    explicit ZobristTable(int flat_size)
+        : flat_size(flat_size), cells(static_cast<std::size_t>(kNumElements * flat_size)) {
+        for (int el = 0; el < kNumElements; ++el) {
+            for (int i = 0; i < flat_size; ++i) {
+                const uint64_t lo = to_local_hash(flat_size, static_cast<Element>(el), i);
+                cells[static_cast<std::size_t>(el * flat_size + i)] = {lo, splitmix64(lo + kHashHiSeedOffset)};
+            }
+            // Prefix XOR over counts 1..n, so a count change is one lookup at each end
+            auto &prefix = inventory_prefix[static_cast<std::size_t>(el)];
+            prefix[0] = {0, 0};
+            for (int count = 1; count < kZobristInventoryCounts; ++count) {
+                prefix[count] = Xor(prefix[count - 1], InventoryKey(static_cast<Element>(el), count));
+            }
+        }
     }
-    if (seglist.size() < 4) {
-        throw std::invalid_argument("Board string should have at minimum 4 values separated by '|'.");
+
+    [[nodiscard]] auto cell(Element el, int index) const noexcept -> Key {
+        return cells[static_cast<std::size_t>(to_underlying(el) * flat_size + index)];
     }
 
-    // Get general info
-    rows = std::stoi(seglist[0]);
-    cols = std::stoi(seglist[1]);
-    int _goal = std::stoi(seglist[2]);
-    if (seglist.size() != static_cast<std::size_t>(rows * cols) + 3) {
-        throw std::invalid_argument("Supplied rows/cols does not match input board length.");
+    // XOR of the keys for counts 1..count of an element
+    [[nodiscard]] auto inventory(Element el, int count) const noexcept -> Key {
+        const auto &prefix = inventory_prefix[static_cast<std::size_t>(el)];
+        if (count < kZobristInventoryCounts) {
+            return prefix[std::max(count, 0)];
+        }
+        Key key = prefix[kZobristInventoryCounts - 1];
+        for (int c = kZobristInventoryCounts; c <= count; ++c) {
+            key = Xor(key, InventoryKey(el, c));
+        }
+        return key;
     }
-    if (_goal < kPrimitiveStart || _goal >= (kNumPrimitive + kNumRecipeTypes + kPrimitiveStart)) {
-        throw std::invalid_argument("Unknown goal element.");
+
+private:
+    static auto Xor(Key lhs, Key rhs) noexcept -> Key {
+        return {lhs.lo ^ rhs.lo, lhs.hi ^ rhs.hi};
     }
-    goal = static_cast<Element>(_goal);
 
-    // Parse grid
-    for (std::size_t i = 3; i < seglist.size(); ++i) {
-        int el_idx = std::stoi(seglist[i]);
-        if (el_idx < 0 || el_idx > kNumElements) {
-            throw std::invalid_argument(std::string("Unknown element type: ") + seglist[i]);
-        }
+    [[nodiscard]] auto InventoryKey(Element el, int count) const noexcept -> Key {
+        const uint64_t lo = to_local_inventory_hash(flat_size, el, count);
+        return {lo, splitmix64(lo + kHashHiSeedOffset)};
+    }
 
-        if (static_cast<Element>(el_idx) == Element::kAgent) {
-            agent_idx = static_cast<int>(i) - 3;
+    int flat_size;
+    std::vector<Key> cells;    // Key per (element, index)
+    std::array<std::array<Key, kZobristInventoryCounts>, kNumElements> inventory_prefix{};
+};
+
+namespace {
+// Tables are built on first use of each board size, then read without locking.
+// Sizes past the inline boards are rare, so they share a locked map rather than a slot each.
+auto zobrist_table(int flat_size) -> const ZobristTable * {
+    constexpr auto kMaxFlatSize = static_cast<std::size_t>(kMaxInlineBoardDim * kMaxInlineBoardDim);
+    static std::array<std::once_flag, kMaxFlatSize + 1> flags;
+    static std::array<std::unique_ptr<const ZobristTable>, kMaxFlatSize + 1> tables;
+    const auto idx = static_cast<std::size_t>(flat_size);
+    if (idx > kMaxFlatSize) {
+        static std::mutex large_tables_mutex;
+        static std::unordered_map<int, std::unique_ptr<const ZobristTable>> large_tables;
+        const std::lock_guard<std::mutex> lock(large_tables_mutex);
+        auto &table = large_tables[flat_size];
+        if (!table) {
+            table = std::make_unique<const ZobristTable>(flat_size);
         }
+        return table.get();
+    }
+    std::call_once(flags[idx], [&]() { tables[idx] = std::make_unique<const ZobristTable>(flat_size); });
+    return tables[idx].get();
+}
+}    // namespace
 
-        grid.push_back(static_cast<Element>(el_idx));
+CraftWorldGameState::CraftWorldGameState(std::string_view board_str) {
+    // Segments are separated by '|', with a trailing separator ignored
+    std::size_t num_segments =
+        board_str.empty() ? 0 : static_cast<std::size_t>(std::count(board_str.begin(), board_str.end(), '|')) + 1;
+    if (!board_str.empty() && board_str.back() == '|') {
+        --num_segments;
+    }
+    if (num_segments < 4) {
+        throw std::invalid_argument("Board string should have at minimum 4 values separated by '|'.");
     }
-    assert(static_cast<int>(grid.size()) == rows * cols);
 
-    // Set initial hash for game world
-    int flat_size = rows * cols;
-    hash = 0;
-    for (int i = 0; i < flat_size; ++i) {
-        hash ^= to_local_hash(flat_size, grid.at(i), i);
+    // Get general info
+    std::size_t pos = 0;
+    int _rows = 0;
+    int _cols = 0;
+    int _goal = 0;
+    if (!parse_board_value(board_str, pos, _rows) || !parse_board_value(board_str, pos, _cols) ||
+        !parse_board_value(board_str, pos, _goal)) {
+        throw std::invalid_argument("Board rows, cols and goal must be integers.");
     }
+    CheckBoardSize(_rows, _cols);
+    if (num_segments != static_cast<std::size_t>(_rows * _cols) + 3) {
+        throw std::invalid_argument("Supplied rows/cols does not match input board length.");
+    }
+
+    // Parse grid, which only allocates for boards too large to store inline
+    BoardCells cells;
+    cells.resize(static_cast<std::size_t>(_rows * _cols));
+    for (int i = 0; i < _rows * _cols; ++i) {
+        const std::size_t segment_start = pos;
+        int el_idx = -1;
+        if (!parse_board_value(board_str, pos, el_idx) || el_idx < 0 || el_idx >= kNumElements) {
+            const auto segment = board_str.substr(segment_start, pos - 1 - segment_start);
+            throw std::invalid_argument("Unknown element type: " + std::string(segment));
+        }
+        cells[static_cast<std::size_t>(i)] = static_cast<uint8_t>(el_idx);
+    }
+    InitBoard(_rows, _cols, _goal, {cells.data(), static_cast<std::size_t>(_rows * _cols)});
+}
+
+CraftWorldGameState::CraftWorldGameState(int _rows, int _cols, Element _goal, std::span<const uint8_t> cells) {
+    InitBoard(_rows, _cols, static_cast<int>(_goal), cells);
 }
 
 CraftWorldGameState::CraftWorldGameState(InternalState &&internal_state)
     : rows(internal_state.rows),
       cols(internal_state.cols),
-      agent_idx(internal_state.agent_idx),
       goal(static_cast<Element>(internal_state.goal)),
       reward_signal(internal_state.reward_signal),
       hash(internal_state.hash) {
-    grid.clear();
-    for (const auto &el : internal_state.grid) {
-        grid.push_back(static_cast<Element>(el));
+    CheckBoardSize(rows, cols);
+    if (internal_state.grid.size() != static_cast<std::size_t>(rows * cols)) {
+        throw std::invalid_argument("Supplied rows/cols does not match input board length.");
+    }
+    if (internal_state.agent_idx < 0 || internal_state.agent_idx >= rows * cols) {
+        throw std::invalid_argument("Agent index out of range.");
     }
-    inventory.clear();
+    InitPaddedGrid(internal_state.grid);
+    agent_idx = internal_state.agent_idx;
+    agent_padded_idx = ToPaddedIndex(agent_idx);
     for (const auto &[el, count] : internal_state.inventory) {
-        inventory[static_cast<Element>(el)] = count;
+        if (!is_valid_element(static_cast<Element>(el))) {
+            throw std::invalid_argument("Unknown element type in inventory.");
+        }
+        inventory[static_cast<std::size_t>(el)] = count;
     }
+    // Only the low hash word is stored when packing
+    zobrist = zobrist_table(rows * cols);
+    if constexpr (kHash128) {
+        hash_hi = ComputeHash().hi;
+    }
+    board_hash = ComputeBoardHash();
 }
 
 auto CraftWorldGameState::operator==(const CraftWorldGameState &other) const noexcept -> bool {
-    return rows == other.rows && cols == other.cols && agent_idx == other.agent_idx && grid == other.grid &&
-           goal == other.goal && inventory == other.inventory;
+    const auto padded_size = static_cast<std::size_t>((rows + 2) * padded_cols);
+    return rows == other.rows && cols == other.cols && agent_idx == other.agent_idx && goal == other.goal &&
+           inventory == other.inventory &&
+           std::equal(grid.begin(), grid.begin() + padded_size, other.grid.begin());
 }
 
 auto CraftWorldGameState::operator!=(const CraftWorldGameState &other) const noexcept -> bool {
     return !(*this == other);
 }
 
+auto CraftWorldGameState::pack() const -> InternalState {
+    std::vector<int> _grid;
+    std::unordered_map<int, int> _inventory;
+    _grid.reserve(static_cast<std::size_t>(rows * cols));
+    for (int i = 0; i < rows * cols; ++i) {
+        _grid.push_back(static_cast<int>(GetElement(ToPaddedIndex(i))));
+    }
+    for (int el = 0; el < kNumElements; ++el) {
+        if (inventory[el] > 0) {
+            _inventory[el] = inventory[el];
+        }
+    }
+    return {
+        .rows = rows,
+        .cols = cols,
+        .agent_idx = agent_idx,
+        .grid = _grid,
+        .goal = static_cast<int>(goal),
+        .reward_signal = reward_signal,
+        .hash = hash,
+        .inventory = _inventory,
+    };
+}
+
+void CraftWorldGameState::append_bytes(std::vector<uint8_t> &bytes) const {
+    const auto put_le = [&](uint64_t value, int num_bytes) {
+        for (int i = 0; i < num_bytes; ++i) {
+            bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));    // NOLINT(*-magic-numbers)
+        }
+    };
+    const auto num_inventory = std::count_if(inventory.begin(), inventory.end(), [](int c) { return c > 0; });
+    bytes.reserve(bytes.size() + kStateBytesHeaderSize +
+                  static_cast<std::size_t>(num_inventory) * kStateBytesInventoryEntrySize +
+                  static_cast<std::size_t>(rows * cols));
+    put_le(kStateBytesVersion, 1);
+    put_le(static_cast<uint64_t>(rows), 1);
+    put_le(static_cast<uint64_t>(cols), 1);
+    put_le(static_cast<uint64_t>(goal), 1);
+    put_le(static_cast<uint64_t>(agent_idx), 4);
+    put_le(reward_signal, 8);    // NOLINT(*-magic-numbers)
+    put_le(static_cast<uint64_t>(num_inventory), 1);
+    for (int el = 0; el < kNumElements; ++el) {
+        if (inventory[static_cast<std::size_t>(el)] > 0) {
+            put_le(static_cast<uint64_t>(el), 1);
+            put_le(static_cast<uint64_t>(inventory[static_cast<std::size_t>(el)]), 4);
+        }
+    }
+    for (int i = 0; i < rows; ++i) {
+        const auto row_begin = grid.begin() + (i + 1) * padded_cols + 1;
+        bytes.insert(bytes.end(), row_begin, row_begin + cols);
+    }
+}
+
+auto CraftWorldGameState::to_bytes() const -> std::vector<uint8_t> {
+    std::vector<uint8_t> bytes;
+    append_bytes(bytes);
+    return bytes;
+}
+
+auto CraftWorldGameState::read_bytes(std::span<const uint8_t> bytes, std::size_t &offset) -> CraftWorldGameState {
+    const auto take = [&](std::size_t num_bytes) {
+        if (offset > bytes.size() || bytes.size() - offset < num_bytes) {
+            throw std::invalid_argument("Encoded state is truncated.");
+        }
+        const auto data = bytes.subspan(offset, num_bytes);
+        offset += num_bytes;
+        return data;
+    };
+    const auto get_le = [](std::span<const uint8_t> data) {
+        uint64_t value = 0;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);    // NOLINT(*-magic-numbers)
+        }
+        return value;
+    };
+
+    const auto header = take(kStateBytesHeaderSize);
+    if (header[0] != kStateBytesVersion) {
+        throw std::invalid_argument("Unsupported state encoding version " + std::to_string(header[0]) + ".");
+    }
+    const int _rows = header[1];
+    const int _cols = header[2];
+    const int _goal = header[3];
+    const auto _agent_idx = get_le(header.subspan(4, 4));
+    const auto _reward_signal = get_le(header.subspan(8, 8));    // NOLINT(*-magic-numbers)
+    const int num_inventory = header[16];                          // NOLINT(*-magic-numbers)
+    std::array<int, kNumElements> _inventory{};
+    for (int i = 0; i < num_inventory; ++i) {
+        const auto entry = take(kStateBytesInventoryEntrySize);
+        const auto count = get_le(entry.subspan(1, 4));
+        if (entry[0] >= kNumElements || count > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::invalid_argument("Invalid inventory entry in encoded state.");
+        }
+        _inventory[entry[0]] = static_cast<int>(count);
+    }
+    CheckBoardSize(_rows, _cols);
+    if (_agent_idx >= static_cast<uint64_t>(_rows * _cols)) {
+        throw std::invalid_argument("Agent index out of range.");
+    }
+
+    const auto cells = take(static_cast<std::size_t>(_rows * _cols));
+    CraftWorldGameState state(_rows, _cols, static_cast<Element>(_goal), cells);
+    state.agent_idx = static_cast<int>(_agent_idx);
+    state.agent_padded_idx = state.ToPaddedIndex(state.agent_idx);
+    state.reward_signal = _reward_signal;
+    // Board hash is set by the constructor, so only the inventory keys need adding
+    for (int el = 0; el < kNumElements; ++el) {
+        state.inventory[static_cast<std::size_t>(el)] = _inventory[static_cast<std::size_t>(el)];
+        state.XorInventoryHash(static_cast<Element>(el), 0, _inventory[static_cast<std::size_t>(el)]);
+    }
+    return state;
+}
+
+auto CraftWorldGameState::from_bytes(std::span<const uint8_t> bytes) -> CraftWorldGameState {
+    std::size_t offset = 0;
+    auto state = read_bytes(bytes, offset);
+    if (offset != bytes.size()) {
+        throw std::invalid_argument("Encoded state has trailing bytes.");
+    }
+    return state;
+}
+
+void CraftWorldGameState::CheckBoardSize(int rows, int cols) {
+    if (rows <= 0 || cols <= 0 || rows > kMaxBoardDim || cols > kMaxBoardDim) {
+        throw std::invalid_argument("rows/cols must be in the range [1, " + std::to_string(kMaxBoardDim) + "].");
+    }
+}
+
+void CraftWorldGameState::InitBoard(int _rows, int _cols, int _goal, std::span<const uint8_t> cells) {
+    CheckBoardSize(_rows, _cols);
+    if (cells.size() != static_cast<std::size_t>(_rows * _cols)) {
+        throw std::invalid_argument("Supplied rows/cols does not match input board length.");
+    }
+    if (_goal < kPrimitiveStart || _goal >= (kNumPrimitive + kNumRecipeTypes + kPrimitiveStart)) {
+        throw std::invalid_argument("Unknown goal element.");
+    }
+    rows = _rows;
+    cols = _cols;
+    goal = static_cast<Element>(_goal);
+
+    padded_cols = cols + 2;
+    grid.resize(static_cast<std::size_t>((rows + 2) * padded_cols));
+    std::fill(grid.begin(), grid.end(), static_cast<uint8_t>(Element::kWall));
+    for (int i = 0; i < rows * cols; ++i) {
+        const uint8_t el_idx = cells[static_cast<std::size_t>(i)];
+        if (el_idx >= kNumElements) {
+            throw std::invalid_argument("Unknown element type: " + std::to_string(el_idx));
+        }
+        if (static_cast<Element>(el_idx) == Element::kAgent) {
+            agent_idx = i;
+        }
+        grid[static_cast<std::size_t>(ToPaddedIndex(i))] = el_idx;
+    }
+    agent_padded_idx = ToPaddedIndex(agent_idx);
+
+    // Set initial hash for game world
+    zobrist = zobrist_table(rows * cols);
+    const auto initial_hash = ComputeHash();
+    hash = initial_hash.lo;
+    hash_hi = initial_hash.hi;
+    board_hash = ComputeBoardHash();
+}
+
+void CraftWorldGameState::InitPaddedGrid(const std::vector<int> &flat_grid) {
+    padded_cols = cols + 2;
+    grid.resize(static_cast<std::size_t>((rows + 2) * padded_cols));
+    std::fill(grid.begin(), grid.end(), static_cast<uint8_t>(Element::kWall));
+    for (int i = 0; i < rows * cols; ++i) {
+        if (static_cast<Element>(flat_grid[i]) == Element::kAgent) {
+            agent_idx = i;
+        }
+        grid[ToPaddedIndex(i)] = static_cast<uint8_t>(flat_grid[i]);
+    }
+    agent_padded_idx = ToPaddedIndex(agent_idx);
+}
+
 // ---------------------------------------------------------------------------
 
-void CraftWorldGameState::RemoveItemFromBoard(int index) noexcept {
-    Element el = grid.at(index);
-    auto flat_size = rows * cols;
-    hash ^= to_local_hash(flat_size, el, index);
-    grid.at(index) = Element::kEmpty;
-    hash ^= to_local_hash(flat_size, Element::kEmpty, index);
+template <int Cols>
+void CraftWorldGameState::RemoveItemFromBoard(int padded_index) noexcept {
+    Element el = GetElement(padded_index);
+    auto index = FromPaddedIndex<Cols>(padded_index);
+    board_hash ^= XorCellHash(el, index);
+    RecordCellChange(padded_index, el);
+    grid[padded_index] = static_cast<uint8_t>(Element::kEmpty);
+    board_hash ^= XorCellHash(Element::kEmpty, index);
 }
 
+auto CraftWorldGameState::ComputeHash() const noexcept -> Hash128 {
+    Hash128 result;
+    for (int i = 0; i < rows * cols; ++i) {
+        const auto key = zobrist->cell(GetElement(ToPaddedIndex(i)), i);
+        result.lo ^= key.lo;
+        result.hi ^= key.hi;
+    }
+    for (int el = 0; el < kNumElements; ++el) {
+        const auto key = zobrist->inventory(static_cast<Element>(el), inventory[static_cast<std::size_t>(el)]);
+        result.lo ^= key.lo;
+        result.hi ^= key.hi;
+    }
+    return result;
+}
+
+auto CraftWorldGameState::ComputeBoardHash() const noexcept -> uint64_t {
+    uint64_t result = 0;
+    for (int i = 0; i < rows * cols; ++i) {
+        const auto element = i == agent_idx ? Element::kEmpty : GetElement(ToPaddedIndex(i));
+        result ^= zobrist->cell(element, i).lo;
+    }
+    return result;
+}
+
+// Returns the low key applied, so board_hash can share it
+auto CraftWorldGameState::XorCellHash(Element element, int index) noexcept -> uint64_t {
+    count_event(Counter::kHashUpdates);
+    const auto key = zobrist->cell(element, index);
+    hash ^= key.lo;
+    if constexpr (kHash128) {
+        hash_hi ^= key.hi;
+    }
+    return key.lo;
+}
+
+void CraftWorldGameState::XorInventoryHash(Element element, int from_count, int to_count) noexcept {
+    count_event(Counter::kHashUpdates);
+    // Keys for counts between the two cancel out of the prefixes
+    const auto from_key = zobrist->inventory(element, from_count);
+    const auto to_key = zobrist->inventory(element, to_count);
+    hash ^= from_key.lo ^ to_key.lo;
+    if constexpr (kHash128) {
+        hash_hi ^= from_key.hi ^ to_key.hi;
+    }
+}
+
+void CraftWorldGameState::RecordCellChange(int padded_index, Element prev_element) noexcept {
+    assert(delta.num_cells < static_cast<int>(delta.cells.size()));
+    delta.cells[static_cast<std::size_t>(delta.num_cells)] = padded_index;
+    delta.prev_cells[static_cast<std::size_t>(delta.num_cells)] = static_cast<uint8_t>(prev_element);
+    ++delta.num_cells;
+}
+
+// Crafting changes the most inventory items in one action, each input and the output
+static_assert(kMaxRecipeInputs + 1 <= std::tuple_size_v<decltype(CraftWorldGameState::StepDelta::prev_elements)>,
+              "StepDelta must hold every inventory change of a craft");
+
+void CraftWorldGameState::RecordInventoryChange(Element element) noexcept {
+    const uint32_t bit = 1U << static_cast<uint32_t>(element);
+    // Only the count before the first change is needed, and the static_assert above bounds the changes per action
+    if ((delta.inventory_mask & bit) == 0 && delta.num_inventory < static_cast<int>(delta.prev_elements.size())) {
+        delta.prev_elements[static_cast<std::size_t>(delta.num_inventory)] = static_cast<uint8_t>(element);
+        delta.prev_counts[static_cast<std::size_t>(delta.num_inventory)] =
+            inventory[static_cast<std::size_t>(element)];
+        ++delta.num_inventory;
+    }
+    delta.inventory_mask |= bit;
+}
+
+template <int Cols>
 void CraftWorldGameState::HandleAgentMovement(Action action) noexcept {
-    // Move if in bound and empty tile
-    auto new_idx = IndexFromAction(agent_idx, action);
-    int flat_size = rows * cols;
-    if (InBounds(agent_idx, action) && grid.at(new_idx) == Element::kEmpty) {
+    // Move if empty tile, sentinel walls keep the agent in bounds
+    auto new_padded_idx = PaddedIndexFromAction<Cols>(agent_padded_idx, action);
+    if (GetElement(new_padded_idx) == Element::kEmpty) {
+        auto new_idx = IndexFromAction<Cols>(agent_idx, action);
         // Undo hash
-        hash ^= to_local_hash(flat_size, Element::kAgent, agent_idx);
-        hash ^= to_local_hash(flat_size, Element::kEmpty, new_idx);
+        XorCellHash(Element::kAgent, agent_idx);
+        XorCellHash(Element::kEmpty, new_idx);
         // Change hash
-        hash ^= to_local_hash(flat_size, Element::kAgent, new_idx);
-        hash ^= to_local_hash(flat_size, Element::kEmpty, agent_idx);
+        XorCellHash(Element::kAgent, new_idx);
+        XorCellHash(Element::kEmpty, agent_idx);
         // Move
-        grid.at(new_idx) = Element::kAgent;
-        grid.at(agent_idx) = Element::kEmpty;
+        RecordCellChange(agent_padded_idx, Element::kAgent);
+        RecordCellChange(new_padded_idx, Element::kEmpty);
+        grid[new_padded_idx] = static_cast<uint8_t>(Element::kAgent);
+        grid[agent_padded_idx] = static_cast<uint8_t>(Element::kEmpty);
         agent_idx = new_idx;
+        agent_padded_idx = new_padded_idx;
+    } else {
+        count_event(Counter::kBlockedMoves);
     }
 }
 
-void CraftWorldGameState::HandleAgentUse() noexcept {
+template <int Cols>
+auto CraftWorldGameState::FindUseTarget() const noexcept -> UseTarget {
     for (const auto &action : kAllActions) {
-        if (!InBounds(agent_idx, action)) {
-            continue;
-        }
-        int neighbour_idx = IndexFromAction(agent_idx, action);
+        // Sentinel walls are never interacted with, so no bounds check needed
+        const int neighbour_idx = PaddedIndexFromAction<Cols>(agent_padded_idx, action);
         // Nothing on this index to do something
-        if (grid.at(neighbour_idx) == Element::kEmpty) {
+        if (IsItem(neighbour_idx, Element::kEmpty)) {
             continue;
         }
 
         if (IsPrimitive(neighbour_idx)) {
-            // Primitive elements on map are collectable, add to inventory
-            const Element el = grid.at(neighbour_idx);
-            if (el != Element::kGrass) {
-                AddToInventory(el, 1);
-            }
-            RemoveItemFromBoard(neighbour_idx);
-            reward_signal |= static_cast<std::underlying_type_t<RewardCode>>(kPrimitiveRewardMap.at(el));
-            break;
-        } else if (grid.at(neighbour_idx) == Element::kIron && HasItemInInventory(Element::kBronzePick)) {
+            // Primitive elements on map are collectable
+            return {.kind = UseKind::kCollect, .padded_idx = neighbour_idx};
+        } else if (IsItem(neighbour_idx, Element::kIron) && HasItemInInventory(Element::kBronzePick)) {
             // Iron ingot is special primitive where we need a cobble stone pickaxe to gather
-            const Element el = grid.at(neighbour_idx);
-            AddToInventory(el, 1);
-            RemoveItemFromBoard(neighbour_idx);
-            reward_signal |= static_cast<std::underlying_type_t<RewardCode>>(kPrimitiveRewardMap.at(el));
-            break;
+            return {.kind = UseKind::kCollect, .padded_idx = neighbour_idx};
         } else if (IsWorkShop(neighbour_idx)) {
-            const Element el_workshop = grid.at(neighbour_idx);
-            for (const auto &[recipe_type, recipe_item] : kRecipeMap) {
-                // Skip recipes not legal at this workshop
-                const auto recipe_workshop = recipe_item.location;
-                if (recipe_workshop != el_workshop) {
-                    continue;
-                }
-                // Skip if we don't have the items required in our inventory
-                if (!CanCraftItem(recipe_item)) {
-                    continue;
+            // Craft the first recipe at this workshop we have the ingredients for, see kWorkshopRecipes.
+            // The first workshop found is used even if nothing can be crafted there.
+            const auto &workshop = kWorkshopRecipes[static_cast<std::size_t>(GetElement(neighbour_idx))];
+            for (int i = 0; i < workshop.num_recipes; ++i) {
+                const auto &recipe = kRecipes[static_cast<std::size_t>(workshop.recipes[static_cast<std::size_t>(i)])];
+                if (CanCraftItem(recipe)) {
+                    return {.kind = UseKind::kCraft, .padded_idx = neighbour_idx, .recipe = &recipe};
                 }
-
-                // Add crafted item and remove ingredients from inventory
-                AddToInventory(recipe_item.output, 1);
-                for (auto const &ingredient_item : recipe_item.inputs) {
-                    RemoveFromInventory(ingredient_item.element, ingredient_item.count);
-                }
-                reward_signal |=
-                    static_cast<std::underlying_type_t<RewardCode>>(kRecipeRewardMap.at(recipe_item.recipe));
-                reward_signal |= static_cast<std::underlying_type_t<RewardCode>>(kWorkstationRewardMap.at(el_workshop));
-                break;
             }
-            break;
-        } else if (IsItem(neighbour_idx, Element::kWater)) {
+            return {};
+        } else if (IsItem(neighbour_idx, Element::kWater) && HasItemInInventory(Element::kBridge)) {
             // Remove water with a bridge
-            if (HasItemInInventory(Element::kBridge)) {
-                RemoveFromInventory(Element::kBridge, 1);
-                RemoveItemFromBoard(neighbour_idx);
-                reward_signal |= static_cast<std::underlying_type_t<RewardCode>>(RewardCode::kRewardCodeUseBridge);
-                break;
-            }
-        } else if (IsItem(neighbour_idx, Element::kStone)) {
+            return {.kind = UseKind::kBridge, .padded_idx = neighbour_idx};
+        } else if (IsItem(neighbour_idx, Element::kStone) && HasItemInInventory(Element::kIronPick)) {
             // Remove stone with an axe
-            if (HasItemInInventory(Element::kIronPick)) {
-                RemoveFromInventory(Element::kIronPick, 1);
-                RemoveItemFromBoard(neighbour_idx);
-                reward_signal |= static_cast<std::underlying_type_t<RewardCode>>(RewardCode::kRewardCodeUseAxe);
-                break;
+            return {.kind = UseKind::kAxe, .padded_idx = neighbour_idx};
+        }
+    }
+    return {};
+}
+
+template <int Cols>
+void CraftWorldGameState::HandleAgentUse() noexcept {
+    const auto target = FindUseTarget<Cols>();
+    switch (target.kind) {
+        case UseKind::kNone:
+            count_event(Counter::kNoOpUses);
+            return;
+        case UseKind::kCollect: {
+            count_event(Counter::kCollects);
+            const Element el = GetElement(target.padded_idx);
+            if (el != Element::kGrass) {
+                AddToInventory(el, 1);
+            }
+            RemoveItemFromBoard<Cols>(target.padded_idx);
+            reward_signal |= kCollectReward[static_cast<std::size_t>(el)];
+            return;
+        }
+        case UseKind::kCraft: {
+            count_event(Counter::kCrafts);
+            // Add crafted item and remove ingredients from inventory
+            const auto &recipe = *target.recipe;
+            AddToInventory(recipe.output, 1);
+            for (int j = 0; j < recipe.num_inputs; ++j) {
+                const auto &ingredient_item = recipe.inputs[static_cast<std::size_t>(j)];
+                RemoveFromInventory(ingredient_item.element, ingredient_item.count);
             }
+            reward_signal |= recipe.reward;
+            return;
         }
+        case UseKind::kBridge:
+            count_event(Counter::kBridgeUses);
+            RemoveFromInventory(Element::kBridge, 1);
+            RemoveItemFromBoard<Cols>(target.padded_idx);
+            reward_signal |= static_cast<std::underlying_type_t<RewardCode>>(RewardCode::kRewardCodeUseBridge);
+            return;
+        case UseKind::kAxe:
+            count_event(Counter::kAxeUses);
+            RemoveFromInventory(Element::kIronPick, 1);
+            RemoveItemFromBoard<Cols>(target.padded_idx);
+            reward_signal |= static_cast<std::underlying_type_t<RewardCode>>(RewardCode::kRewardCodeUseAxe);
+            return;
     }
 }
 
+template <int Cols>
+auto CraftWorldGameState::EffectiveActionMask() const noexcept -> uint8_t {
+    uint8_t mask = 0;
+    // Movement only happens onto empty cells, mirroring HandleAgentMovement
+    for (const auto &action : kAllActions) {
+        if (action != Action::kUse &&
+            GetElement(PaddedIndexFromAction<Cols>(agent_padded_idx, action)) == Element::kEmpty) {
+            mask |= static_cast<uint8_t>(1U << static_cast<uint32_t>(action));
+        }
+    }
+    if (FindUseTarget<Cols>().kind != UseKind::kNone) {
+        mask |= static_cast<uint8_t>(1U << static_cast<uint32_t>(Action::kUse));
+    }
+    return mask;
+}
+
 void CraftWorldGameState::apply_action(Action action) {
+    ApplyAction<0>(action);
+}
+
+auto CraftWorldGameState::apply_action_with_undo(Action action) -> UndoRecord {
+    return ApplyActionWithUndo<0>(action);
+}
+
+void CraftWorldGameState::undo(const UndoRecord &record) noexcept {
+    Undo<0>(record);
+}
+
+auto CraftWorldGameState::effective_action_mask() const noexcept -> uint8_t {
+    return EffectiveActionMask<0>();
+}
+
+template <int Cols>
+void CraftWorldGameState::ApplyAction(Action action) noexcept {
     assert(is_valid_action(action));
+    const ScopedTimer timer(Timer::kApplyAction);
+    // Action counters are laid out in Action order
+    count_event(static_cast<Counter>(action));
     reward_signal = 0;
+    delta = {};
     if (action == Action::kUse) {
-        HandleAgentUse();
+        HandleAgentUse<Cols>();
     } else {
-        HandleAgentMovement(action);
+        HandleAgentMovement<Cols>(action);
+    }
+}
+
+template <int Cols>
+auto CraftWorldGameState::ApplyActionWithUndo(Action action) noexcept -> UndoRecord {
+    const auto prev_hash = hash;
+    const auto prev_hash_hi = hash_hi;
+    const auto prev_reward_signal = reward_signal;
+    const auto prev_board_hash = board_hash;
+    const auto prev_agent_idx = agent_idx;
+    ApplyAction<Cols>(action);
+    return {.delta = delta,
+            .hash = prev_hash,
+            .hash_hi = prev_hash_hi,
+            .reward_signal = prev_reward_signal,
+            .board_hash = prev_board_hash,
+            .agent_idx = prev_agent_idx};
+}
+
+template <int Cols>
+void CraftWorldGameState::Undo(const UndoRecord &record) noexcept {
+    const auto &changes = record.delta;
+    // Reverse order, in case a change was made on top of another
+    for (int i = changes.num_cells - 1; i >= 0; --i) {
+        grid[static_cast<std::size_t>(changes.cells[static_cast<std::size_t>(i)])] =
+            changes.prev_cells[static_cast<std::size_t>(i)];
+    }
+    for (int i = changes.num_inventory - 1; i >= 0; --i) {
+        const auto idx = static_cast<std::size_t>(i);
+        inventory[changes.prev_elements[idx]] = changes.prev_counts[idx];
     }
+    hash = record.hash;
+    hash_hi = record.hash_hi;
+    reward_signal = record.reward_signal;
+    board_hash = record.board_hash;
+    agent_idx = record.agent_idx;
+    agent_padded_idx = ToPaddedIndex<Cols>(agent_idx);
+
+    // Undo touches the same cells and items, so observations can be patched back
+    delta = {};
+    delta.cells = changes.cells;
+    delta.num_cells = changes.num_cells;
+    delta.inventory_mask = changes.inventory_mask;
 }
 
 auto CraftWorldGameState::is_solution() const noexcept -> bool {
     // Inventory contains the goal item
-    return inventory.find(goal) != inventory.end();
+    return inventory[static_cast<std::size_t>(goal)] > 0;
 }
 
 auto CraftWorldGameState::observation_shape() const noexcept -> std::array<int, 3> {
@@ -243,164 +765,287 @@ auto CraftWorldGameState::observation_shape() const noexcept -> std::array<int,
 }
 
 auto CraftWorldGameState::get_observation() const noexcept -> std::vector<float> {
-    const auto rows_obs = rows + 4;
-    const auto cols_obs = cols + 4;
-    const auto channel_length = rows_obs * cols_obs;
+    std::vector<float> obs(static_cast<std::size_t>(kNumElements * (rows + 4) * (cols + 4)), 0);
+    write_observation(obs);
+    return obs;
+}
+
+void CraftWorldGameState::write_observation(std::span<float> obs) const {
+    CheckObservationSize(obs.size());
+    DenseObservation<float> out{obs};
+    WriteObservation<0, 0>(out);
+}
 
-    std::vector<float> obs(kNumElements * channel_length, 0);
+void CraftWorldGameState::write_observation_uint8(std::span<uint8_t> obs) const {
+    CheckObservationSize(obs.size());
+    DenseObservation<uint8_t> out{obs};
+    WriteObservation<0, 0>(out);
+}
+
+auto CraftWorldGameState::packed_observation_size() const noexcept -> int {
+    return (kNumElements * (rows + 4) * (cols + 4) + 7) / 8;
+}
+
+void CraftWorldGameState::write_observation_packed(std::span<uint8_t> obs) const {
+    if (obs.size() != static_cast<std::size_t>(packed_observation_size())) {
+        throw std::invalid_argument("Observation buffer size does not match packed_observation_size().");
+    }
+    PackedObservation out{obs};
+    WriteObservation<0, 0>(out);
+}
+
+void CraftWorldGameState::update_observation(std::span<float> obs) const {
+    CheckObservationSize(obs.size());
+    DenseObservation<float> out{obs};
+    UpdateObservation<0, 0>(out);
+}
+
+auto CraftWorldGameState::get_egocentric_observation(int radius) const -> std::vector<float> {
+    if (radius < 0) {
+        throw std::invalid_argument("Observation radius must be non-negative.");
+    }
+    const auto [c, h, w] = egocentric_observation_shape(radius);
+    std::vector<float> obs(static_cast<std::size_t>(c) * static_cast<std::size_t>(h) * static_cast<std::size_t>(w), 0);
+    write_egocentric_observation(obs, radius);
+    return obs;
+}
+
+void CraftWorldGameState::write_egocentric_observation(std::span<float> obs, int radius) const {
+    const ScopedTimer timer(Timer::kWriteEgocentricObservation);
+    if (radius < 0) {
+        throw std::invalid_argument("Observation radius must be non-negative.");
+    }
+    const int side = (2 * radius) + 1;
+    const auto channel_length = static_cast<std::size_t>(side) * static_cast<std::size_t>(side);
+    if (obs.size() != kNumElements * channel_length) {
+        throw std::invalid_argument("Observation buffer size does not match egocentric_observation_shape().");
+    }
+    std::fill(obs.begin(), obs.end(), 0.0F);
+
+    // Window rows/cols which overlap the board, everything else is outside and shown as wall
+    const int top = (agent_idx / cols) - radius;
+    const int left = (agent_idx % cols) - radius;
+    const int row_begin = std::max(0, -top);
+    const int row_end = std::min(side, rows - top);
+    const int col_begin = std::max(0, -left);
+    const int col_end = std::min(side, cols - left);
+    const auto wall_offset = static_cast<std::size_t>(Element::kWall) * channel_length;
+    for (int r = 0; r < side; ++r) {
+        const bool row_inside = r >= row_begin && r < row_end;
+        for (int c = 0; c < side; ++c) {
+            const auto idx = static_cast<std::size_t>((r * side) + c);
+            if (!row_inside || c < col_begin || c >= col_end) {
+                obs[wall_offset + idx] = 1;
+                continue;
+            }
+            // Padded grid is offset by 1 from the board
+            const auto el = grid[static_cast<std::size_t>(((top + r + 1) * padded_cols) + (left + c + 1))];
+            obs[(static_cast<std::size_t>(el) * channel_length) + idx] = 1;
+        }
+    }
+}
+
+auto CraftWorldGameState::get_inventory_observation() const -> std::vector<float> {
+    std::vector<float> obs(kInventoryObservationSize, 0);
+    write_inventory_observation(obs);
+    return obs;
+}
+
+void CraftWorldGameState::write_inventory_observation(std::span<float> obs) const {
+    if (obs.size() != kInventoryObservationSize) {
+        throw std::invalid_argument("Inventory observation buffer size does not match kInventoryObservationSize.");
+    }
+    for (const auto &slot : kInventorySlots) {
+        const auto count = inventory[static_cast<std::size_t>(slot.element)];
+        obs[static_cast<std::size_t>(slot.index)] = static_cast<float>(count >= slot.min_count);
+    }
+}
+
+void CraftWorldGameState::CheckObservationSize(std::size_t size) const {
+    if (size != static_cast<std::size_t>(kNumElements * (rows + 4) * (cols + 4))) {
+        throw std::invalid_argument("Observation buffer size does not match observation_shape().");
+    }
+}
+
+template <int Rows, int Cols, typename ObsT>
+void CraftWorldGameState::WriteObservation(ObsT &obs) const {
+    const ScopedTimer timer(Timer::kWriteObservation);
+    const auto rows_obs = BoardRows<Rows>() + 4;
+    const auto cols_obs = BoardCols<Cols>() + 4;
+    const auto channel_length = rows_obs * cols_obs;
+    obs.clear();
 
     // Inner border is wall
     for (int w = 1; w < cols_obs - 1; ++w) {
         const auto channel = static_cast<std::size_t>(Element::kWall);
-        obs[channel * channel_length + (1 * cols_obs + w)] = 1;
-        obs[channel * channel_length + ((rows_obs - 2) * cols_obs + w)] = 1;
+        obs.set(channel * channel_length + (1 * cols_obs + w), true);
+        obs.set(channel * channel_length + ((rows_obs - 2) * cols_obs + w), true);
     }
     for (int h = 1; h < rows_obs - 1; ++h) {
         const auto channel = static_cast<std::size_t>(Element::kWall);
-        obs[channel * channel_length + (h * cols_obs + 1)] = 1;
-        obs[channel * channel_length + (h * cols_obs + (cols_obs - 2))] = 1;
+        obs.set(channel * channel_length + (h * cols_obs + 1), true);
+        obs.set(channel * channel_length + (h * cols_obs + (cols_obs - 2)), true);
     }
 
     // Outer border is empty (for now, dont forget to undo for inventory items)
     for (int w = 0; w < cols_obs; ++w) {
         const auto channel = static_cast<std::size_t>(Element::kEmpty);
-        obs[channel * channel_length + (0 * cols_obs + w)] = 1;
-        obs[channel * channel_length + ((rows_obs - 1) * cols_obs + w)] = 1;
+        obs.set(channel * channel_length + (0 * cols_obs + w), true);
+        obs.set(channel * channel_length + ((rows_obs - 1) * cols_obs + w), true);
     }
     for (int h = 1; h < rows_obs - 1; ++h) {
         const auto channel = static_cast<std::size_t>(Element::kEmpty);
-        obs[channel * channel_length + (h * cols_obs + 0)] = 1;
-        obs[channel * channel_length + (h * cols_obs + (cols_obs - 1))] = 1;
+        obs.set(channel * channel_length + (h * cols_obs + 0), true);
+        obs.set(channel * channel_length + (h * cols_obs + (cols_obs - 1)), true);
     }
 
     // Board environment + primitives + agent
-    std::size_t i = 0;
     for (int r = 2; r < rows_obs - 2; ++r) {
         for (int c = 2; c < cols_obs - 2; ++c) {
-            const auto el = grid.at(i);
+            const auto el = grid[static_cast<std::size_t>((r - 1) * PaddedCols<Cols>() + (c - 1))];
             auto idx = (r * cols_obs) + c;
-            obs.at(static_cast<std::size_t>(el) * channel_length + idx) = 1;
-            ++i;
+            obs.set(static_cast<std::size_t>(el) * channel_length + idx, true);
         }
     }
 
     // Inventory (fill around the border)
-    for (const auto &[inv_el, inv_count] : inventory) {
-        switch (inv_el) {
-            case Element::kWood:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 0) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 0) = 0;
-                if (inv_count > 1) {
-                    obs.at(static_cast<std::size_t>(inv_el) * channel_length + 1) = 1;
-                    obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 1) = 0;
-                }
-                break;
-            case Element::kCopper:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 2) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 2) = 0;
-                break;
-            case Element::kTin:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 3) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 3) = 0;
-                break;
-            case Element::kIron:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 4) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 4) = 0;
-                break;
-            case Element::kStick:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 5) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 5) = 0;
-                if (inv_count > 1) {
-                    obs.at(static_cast<std::size_t>(inv_el) * channel_length + 6) = 1;
-                    obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 6) = 0;
-                }
-                break;
-            case Element::kBronzeBar:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 7) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 7) = 0;
-                break;
-            case Element::kBronzePick:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 8) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 8) = 0;
-                break;
-            case Element::kIronPick:
-                obs.at(static_cast<std::size_t>(inv_el) * channel_length + 9) = 1;
-                obs.at(static_cast<std::size_t>(Element::kEmpty) * channel_length + 9) = 0;
-                break;
-            default:
-                break;
+    for (const auto &slot : kInventorySlots) {
+        const auto count = inventory[static_cast<std::size_t>(slot.element)];
+        if (count >= slot.min_count) {
+            write_inventory_slot(obs, cols_obs, channel_length, slot, count);
         }
     }
-    return obs;
 }
 
-// Spite assets
-#include "assets_all.inc"
-namespace {
-void fill_sprite(std::vector<uint8_t> &img, const std::vector<uint8_t> &sprite_data, std::size_t h, std::size_t w,
-                 std::size_t cols) {
-    const std::size_t img_idx_top_left = h * (SPRITE_DATA_LEN * cols) + (w * SPRITE_DATA_LEN_PER_ROW);
-    for (std::size_t r = 0; r < SPRITE_HEIGHT; ++r) {
-        for (std::size_t c = 0; c < SPRITE_WIDTH; ++c) {
-            const std::size_t data_idx = (r * SPRITE_DATA_LEN_PER_ROW) + (3 * c);
-            const std::size_t img_idx = (r * SPRITE_DATA_LEN_PER_ROW * cols) + (SPRITE_CHANNELS * c) + img_idx_top_left;
-            img[img_idx + 0] = sprite_data[data_idx + 0];
-            img[img_idx + 1] = sprite_data[data_idx + 1];
-            img[img_idx + 2] = sprite_data[data_idx + 2];
+template <int Rows, int Cols, typename ObsT>
+void CraftWorldGameState::UpdateObservation(ObsT &obs) const {
+    const ScopedTimer timer(Timer::kUpdateObservation);
+    const auto cols_obs = BoardCols<Cols>() + 4;
+    const auto channel_length = (BoardRows<Rows>() + 4) * cols_obs;
+    const auto board_padded_cols = PaddedCols<Cols>();
+
+    // Changed board cells, padded grid is offset by 1 from the board and the observation by 2
+    for (int i = 0; i < delta.num_cells; ++i) {
+        const int padded_idx = delta.cells[static_cast<std::size_t>(i)];
+        const auto idx = static_cast<std::size_t>((padded_idx / board_padded_cols + 1) * cols_obs +
+                                                  (padded_idx % board_padded_cols) + 1);
+        for (std::size_t channel = 0; channel < kNumElements; ++channel) {
+            obs.set(channel * channel_length + idx, false);
+        }
+        obs.set(static_cast<std::size_t>(grid[static_cast<std::size_t>(padded_idx)]) * channel_length + idx, true);
+    }
+
+    // Changed inventory items
+    if (delta.inventory_mask == 0) {
+        return;
+    }
+    for (const auto &slot : kInventorySlots) {
+        if (delta.inventory_mask & (1U << static_cast<uint32_t>(slot.element))) {
+            const auto count = inventory[static_cast<std::size_t>(slot.element)];
+            write_inventory_slot(obs, cols_obs, channel_length, slot, count);
         }
     }
 }
-}    // namespace
 
-auto CraftWorldGameState::image_shape() const noexcept -> std::array<int, 3> {
+void unpack_observation(std::span<const uint8_t> packed, std::span<float> obs) {
+    if (packed.size() != (obs.size() + 7) / 8) {
+        throw std::invalid_argument("Packed observation size does not match observation size.");
+    }
+    // Whole bytes first, then the trailing partial byte
+    const std::size_t num_full = obs.size() / 8;
+    for (std::size_t i = 0; i < num_full; ++i) {
+        const uint8_t byte = packed[i];
+        float *out = obs.data() + (i * 8);
+        for (std::size_t bit = 0; bit < 8; ++bit) {
+            out[bit] = static_cast<float>((byte >> bit) & 1U);
+        }
+    }
+    for (std::size_t i = num_full * 8; i < obs.size(); ++i) {
+        obs[i] = static_cast<float>((packed[i >> 3U] >> (i & 7U)) & 1U);
+    }
+}
+
+auto CraftWorldGameState::image_shape(int tile_size) const noexcept -> std::array<int, 3> {
     const auto r = rows + 4;
     const auto c = cols + 4;
-    return {r * SPRITE_HEIGHT, c * SPRITE_WIDTH, SPRITE_CHANNELS};
+    return {r * tile_size, c * tile_size, SPRITE_CHANNELS};
 }
 
-auto CraftWorldGameState::to_image() const noexcept -> std::vector<uint8_t> {
+auto CraftWorldGameState::to_image(int tile_size) const -> std::vector<uint8_t> {
+    const auto [h, w, c] = image_shape(tile_size);
+    std::vector<uint8_t> img(static_cast<std::size_t>(h * w * c), 0);
+    write_image(img, tile_size);
+    return img;
+}
+
+void CraftWorldGameState::write_image(std::span<uint8_t> img, int tile_size) const {
+    const ScopedTimer timer(Timer::kWriteImage);
+    const auto rows_img = rows + 4;
+    const auto cols_img = cols + 4;
+    if (!is_valid_tile_size(tile_size)) {
+        throw std::invalid_argument("Unsupported tile size.");
+    }
+    if (img.size() != static_cast<std::size_t>(rows_img * cols_img * tile_size * tile_size * SPRITE_CHANNELS)) {
+        throw std::invalid_argument("Image buffer size does not match image_shape().");
+    }
+    // Tiles of inline boards fit on the stack
+    constexpr auto kMaxInlineTiles = static_cast<std::size_t>((kMaxInlineBoardDim + 4) * (kMaxInlineBoardDim + 4));
+    std::array<uint8_t, kMaxInlineTiles> inline_tiles{};
+    std::vector<uint8_t> heap_tiles;
+    const auto num_tiles = static_cast<std::size_t>(rows_img * cols_img);
+    if (num_tiles > kMaxInlineTiles) {
+        heap_tiles.resize(num_tiles);
+    }
+    const std::span<uint8_t> tiles = heap_tiles.empty() ? std::span<uint8_t>(inline_tiles).first(num_tiles)
+                                                        : std::span<uint8_t>(heap_tiles);
+    write_tiles(tiles);
+    for (int h = 0; h < rows_img; ++h) {
+        for (int w = 0; w < cols_img; ++w) {
+            draw_tile(img, cols_img, h, w, tiles[static_cast<std::size_t>(h * cols_img + w)], tile_size);
+        }
+    }
+}
+
+void CraftWorldGameState::write_tiles(std::span<uint8_t> tiles) const {
     // Pad board with black border
     const auto rows_img = rows + 4;
     const auto cols_img = cols + 4;
-    const auto channel_length = rows_img * cols_img;
-    std::vector<uint8_t> img(channel_length * SPRITE_DATA_LEN, 0);
+    if (tiles.size() != static_cast<std::size_t>(rows_img * cols_img)) {
+        throw std::invalid_argument("Tile buffer size does not match image tile grid.");
+    }
+    std::fill(tiles.begin(), tiles.end(), kBlankTile);
+    const auto set_tile = [&](int h, int w, uint8_t tile) {
+        tiles[static_cast<std::size_t>(h * cols_img + w)] = tile;
+    };
 
     // Inner border is wall
+    const auto wall = static_cast<uint8_t>(Element::kWall);
     for (int w = 1; w < cols_img - 1; ++w) {
-        fill_sprite(img, img_asset_map.at(Element::kWall), 1, w, cols_img);
-        fill_sprite(img, img_asset_map.at(Element::kWall), rows_img - 2, w, cols_img);
+        set_tile(1, w, wall);
+        set_tile(rows_img - 2, w, wall);
     }
     for (int h = 1; h < rows_img - 1; ++h) {
-        fill_sprite(img, img_asset_map.at(Element::kWall), h, 1, cols_img);
-        fill_sprite(img, img_asset_map.at(Element::kWall), h, cols_img - 2, cols_img);
+        set_tile(h, 1, wall);
+        set_tile(h, cols_img - 2, wall);
     }
 
-    // Outer border is inventory
-    std::vector<std::pair<std::size_t, std::size_t>> indices;
-    for (int w = 0; w < cols_img; ++w) {
-        indices.emplace_back(0, w);
-    }
-    for (int w = 0; w < cols_img; ++w) {
-        indices.emplace_back(rows_img - 1, w);
-    }
-    std::size_t inv_idx = 0;
-    for (const auto &[inv_item, inv_count] : inventory) {
-        for (int i = 0; i < inv_count; ++i) {
-            fill_sprite(img, img_asset_map.at(inv_item), indices[inv_idx].first, indices[inv_idx].second, cols_img);
+    // Outer border is inventory, filling the top row then the bottom row in element order
+    // Items past the available border slots are not drawn
+    int inv_idx = 0;
+    for (int el = 0; el < kNumElements; ++el) {
+        for (int i = 0; i < inventory[el] && inv_idx < 2 * cols_img; ++i) {
+            const int h = inv_idx < cols_img ? 0 : rows_img - 1;
+            set_tile(h, inv_idx % cols_img, static_cast<uint8_t>(el));
             ++inv_idx;
         }
     }
 
     // Reset of board is inside the border
-    std::size_t board_idx = 0;
     for (int h = 2; h < rows_img - 2; ++h) {
         for (int w = 2; w < cols_img - 2; ++w) {
-            const auto el = grid[board_idx];
-            fill_sprite(img, img_asset_map.at(el), h, w, cols_img);
-            ++board_idx;
+            set_tile(h, w, grid[static_cast<std::size_t>((h - 1) * padded_cols + (w - 1))]);
         }
     }
-    return img;
 }
 
 auto CraftWorldGameState::get_reward_signal() const noexcept -> uint64_t {
@@ -411,6 +1056,14 @@ auto CraftWorldGameState::get_hash() const noexcept -> uint64_t {
     return hash;
 }
 
+auto CraftWorldGameState::get_hash128() const noexcept -> Hash128 {
+    if constexpr (kHash128) {
+        return {.lo = hash, .hi = hash_hi};
+    } else {
+        return {.lo = hash, .hi = ComputeHash().hi};
+    }
+}
+
 void CraftWorldGameState::add_to_inventory(Element element, int count) {
     if (!is_valid_element(element)) {
         throw std::invalid_argument("Unknown element type.");
@@ -419,21 +1072,36 @@ void CraftWorldGameState::add_to_inventory(Element element, int count) {
 }
 
 int CraftWorldGameState::check_inventory(Element element) const {
-    if (inventory.find(element) == inventory.end()) {
-        return 0;
+    if (!is_valid_element(element)) {
+        throw std::invalid_argument("Unknown element type.");
     }
-    return inventory.at(element);
+    return inventory[static_cast<std::size_t>(element)];
 }
 
 auto CraftWorldGameState::get_agent_index() const noexcept -> int {
     return agent_idx;
 }
 
+auto CraftWorldGameState::get_goal() const noexcept -> Element {
+    return goal;
+}
+
+auto CraftWorldGameState::get_board_shape() const noexcept -> std::array<int, 2> {
+    return {rows, cols};
+}
+
+auto CraftWorldGameState::get_element(int index) const -> Element {
+    if (index < 0 || index >= rows * cols) {
+        throw std::invalid_argument("Board index out of range.");
+    }
+    return GetElement(ToPaddedIndex(index));
+}
+
 auto CraftWorldGameState::get_indices(Element element) const noexcept -> std::vector<int> {
     assert(is_valid_element(element));
     std::vector<int> indices;
     for (int index = 0; index < rows * cols; ++index) {
-        if (grid.at(index) == element) {
+        if (IsItem(ToPaddedIndex(index), element)) {
             indices.push_back(index);
         }
     }
@@ -448,8 +1116,8 @@ std::ostream &operator<<(std::ostream &os, const CraftWorldGameState &state) {
     for (int h = 0; h < state.rows; ++h) {
         os << "|";
         for (int w = 0; w < state.cols; ++w) {
-            auto idx = h * state.cols + w;
-            os << kElementToSymbolMap.at(state.grid[idx]);
+            auto idx = (h + 1) * state.padded_cols + (w + 1);
+            os << kElementToSymbolMap.at(state.GetElement(idx));
         }
         os << "|" << std::endl;
     }
@@ -459,22 +1127,25 @@ std::ostream &operator<<(std::ostream &os, const CraftWorldGameState &state) {
     os << std::endl;
     os << "Goal: " << kElementToNameMap.at(state.goal) << std::endl;
     os << "Inventory: ";
-    for (const auto &[inv_item, inv_count] : state.inventory) {
-        os << "(" << kElementToNameMap.at(inv_item) << ", " << inv_count << ") ";
+    for (int el = 0; el < kNumElements; ++el) {
+        if (state.inventory[el] > 0) {
+            os << "(" << kElementToNameMap.at(static_cast<Element>(el)) << ", " << state.inventory[el] << ") ";
+        }
     }
     return os;
 }
 
 // ---------------------------------------------------------------------------
 
+template <int Cols>
 auto CraftWorldGameState::IndexFromAction(int index, Action action) const noexcept -> int {
     switch (action) {
         case Action::kUp:
-            return index - cols;
+            return index - BoardCols<Cols>();
         case Action::kRight:
             return index + 1;
         case Action::kDown:
-            return index + cols;
+            return index + BoardCols<Cols>();
         case Action::kLeft:
             return index - 1;
         case Action::kUse:
@@ -484,57 +1155,82 @@ auto CraftWorldGameState::IndexFromAction(int index, Action action) const noexce
     }
 }
 
-auto CraftWorldGameState::InBounds(int index, Action action) const noexcept -> bool {
-    int col = index % cols;
-    int row = (index - col) / cols;
-    const std::pair<int, int> &offsets = kDirectionOffsets.at(static_cast<std::size_t>(action));
-    col += offsets.first;
-    row += offsets.second;
-    return col >= 0 && col < cols && row >= 0 && row < rows;
+template <int Cols>
+auto CraftWorldGameState::PaddedIndexFromAction(int padded_index, Action action) const noexcept -> int {
+    switch (action) {
+        case Action::kUp:
+            return padded_index - PaddedCols<Cols>();
+        case Action::kRight:
+            return padded_index + 1;
+        case Action::kDown:
+            return padded_index + PaddedCols<Cols>();
+        case Action::kLeft:
+            return padded_index - 1;
+        case Action::kUse:
+            return padded_index;
+        default:
+            unreachable();
+    }
+}
+
+template <int Cols>
+auto CraftWorldGameState::ToPaddedIndex(int index) const noexcept -> int {
+    return ((index / BoardCols<Cols>()) + 1) * PaddedCols<Cols>() + (index % BoardCols<Cols>()) + 1;
+}
+
+// Also used by StateArena
+template auto CraftWorldGameState::ToPaddedIndex<0>(int index) const noexcept -> int;
+
+template <int Cols>
+auto CraftWorldGameState::FromPaddedIndex(int padded_index) const noexcept -> int {
+    return ((padded_index / PaddedCols<Cols>()) - 1) * BoardCols<Cols>() + (padded_index % PaddedCols<Cols>()) - 1;
+}
+
+auto CraftWorldGameState::GetElement(int padded_index) const noexcept -> Element {
+    return static_cast<Element>(grid[static_cast<std::size_t>(padded_index)]);
 }
 
-auto CraftWorldGameState::IsWorkShop(int index) const noexcept -> bool {
-    return kWorkShops.find(grid.at(static_cast<std::size_t>(index))) != kWorkShops.end();
+auto CraftWorldGameState::IsWorkShop(int padded_index) const noexcept -> bool {
+    return kIsWorkShop[static_cast<std::size_t>(GetElement(padded_index))];
 }
 
-auto CraftWorldGameState::IsPrimitive(int index) const noexcept -> bool {
-    return kPrimitives.find(grid.at(static_cast<std::size_t>(index))) != kPrimitives.end();
+auto CraftWorldGameState::IsPrimitive(int padded_index) const noexcept -> bool {
+    return kIsPrimitive[static_cast<std::size_t>(GetElement(padded_index))];
 }
 
-auto CraftWorldGameState::IsItem(int index, Element element) const noexcept -> bool {
-    return grid.at(static_cast<std::size_t>(index)) == element;
+auto CraftWorldGameState::IsItem(int padded_index, Element element) const noexcept -> bool {
+    return GetElement(padded_index) == element;
 }
 
 auto CraftWorldGameState::HasItemInInventory(Element element, int min_count) const noexcept -> bool {
-    return inventory.find(element) != inventory.end() && inventory.at(element) >= min_count;
+    return inventory[static_cast<std::size_t>(element)] >= min_count;
 }
 
 void CraftWorldGameState::RemoveFromInventory(Element element, int count) noexcept {
     // Caller needs to verify that we can remove from inventory
-    // Decrement item `count` times and change game state hash
-    assert(inventory.find(element) != inventory.end());
-    assert(inventory.at(element) >= count);
-    int flat_size = rows * cols;
-    for (int i = 0; i < count; ++i) {
-        hash ^= to_local_inventory_hash(flat_size, element, inventory.at(element));
-        --inventory.at(element);
-    }
-    if (inventory.at(element) <= 0) {
-        inventory.erase(element);
+    // Decrement item by `count` and change game state hash
+    auto &inv_count = inventory[static_cast<std::size_t>(element)];
+    assert(inv_count >= count);
+    RecordInventoryChange(element);
+    if (count > 0) {
+        XorInventoryHash(element, inv_count, inv_count - count);
+        inv_count -= count;
     }
 }
 
 void CraftWorldGameState::AddToInventory(Element element, int count) noexcept {
-    // Increment item `count` times and change game state hash
-    int flat_size = rows * cols;
-    for (int i = 0; i < count; ++i) {
-        ++inventory[element];
-        hash ^= to_local_inventory_hash(flat_size, element, inventory.at(element));
+    // Increment item by `count` and change game state hash
+    auto &inv_count = inventory[static_cast<std::size_t>(element)];
+    RecordInventoryChange(element);
+    if (count > 0) {
+        XorInventoryHash(element, inv_count, inv_count + count);
+        inv_count += count;
     }
 }
 
-auto CraftWorldGameState::CanCraftItem(RecipeItem recipe_item) const noexcept -> bool {
-    for (auto const &ingredient_item : recipe_item.inputs) {
+auto CraftWorldGameState::CanCraftItem(const RecipeDef &recipe) const noexcept -> bool {
+    for (int i = 0; i < recipe.num_inputs; ++i) {
+        const auto &ingredient_item = recipe.inputs[static_cast<std::size_t>(i)];
         if (!HasItemInInventory(ingredient_item.element, ingredient_item.count)) {
             return false;
         }
@@ -544,4 +1240,82 @@ auto CraftWorldGameState::CanCraftItem(RecipeItem recipe_item) const noexcept ->
 
 // ---------------------------------------------------------------------------
 
+template <int Rows, int Cols>
+CraftWorldGameStateT<Rows, Cols>::CraftWorldGameStateT(std::string_view board_str)
+    : CraftWorldGameStateT(CraftWorldGameState(board_str)) {}
+
+template <int Rows, int Cols>
+CraftWorldGameStateT<Rows, Cols>::CraftWorldGameStateT(const CraftWorldGameState &state) : CraftWorldGameState(state) {
+    if (rows != Rows || cols != Cols) {
+        throw std::invalid_argument("State rows/cols do not match the fixed board size.");
+    }
+}
+
+template <int Rows, int Cols>
+void CraftWorldGameStateT<Rows, Cols>::apply_action(Action action) {
+    ApplyAction<Cols>(action);
+}
+
+template <int Rows, int Cols>
+auto CraftWorldGameStateT<Rows, Cols>::apply_action_with_undo(Action action) -> UndoRecord {
+    return ApplyActionWithUndo<Cols>(action);
+}
+
+template <int Rows, int Cols>
+void CraftWorldGameStateT<Rows, Cols>::undo(const UndoRecord &record) noexcept {
+    Undo<Cols>(record);
+}
+
+template <int Rows, int Cols>
+auto CraftWorldGameStateT<Rows, Cols>::effective_action_mask() const noexcept -> uint8_t {
+    return EffectiveActionMask<Cols>();
+}
+
+template <int Rows, int Cols>
+auto CraftWorldGameStateT<Rows, Cols>::get_observation() const noexcept -> std::vector<float> {
+    std::vector<float> obs(static_cast<std::size_t>(kNumElements * (Rows + 4) * (Cols + 4)), 0);
+    write_observation(obs);
+    return obs;
+}
+
+template <int Rows, int Cols>
+void CraftWorldGameStateT<Rows, Cols>::write_observation(std::span<float> obs) const {
+    CheckObservationSize(obs.size());
+    DenseObservation<float> out{obs};
+    WriteObservation<Rows, Cols>(out);
+}
+
+template <int Rows, int Cols>
+void CraftWorldGameStateT<Rows, Cols>::update_observation(std::span<float> obs) const {
+    CheckObservationSize(obs.size());
+    DenseObservation<float> out{obs};
+    UpdateObservation<Rows, Cols>(out);
+}
+
+// One specialization per kFixedBoardSizes entry, each an alternative of AnyCraftWorldGameState after the fallback
+template class CraftWorldGameStateT<10, 10>;    // NOLINT(*-magic-numbers)
+template class CraftWorldGameStateT<14, 14>;    // NOLINT(*-magic-numbers)
+template class CraftWorldGameStateT<18, 18>;    // NOLINT(*-magic-numbers)
+static_assert(std::variant_size_v<AnyCraftWorldGameState> == kFixedBoardSizes.size() + 1);
+
+namespace {
+// Convert to the first specialization from alternative I onwards matching the board size
+template <std::size_t I = 1>
+auto to_fixed_state(const CraftWorldGameState &state) -> AnyCraftWorldGameState {
+    if constexpr (I < std::variant_size_v<AnyCraftWorldGameState>) {
+        const auto [fixed_rows, fixed_cols] = kFixedBoardSizes[I - 1];
+        if (state.get_board_shape() == std::array<int, 2>{fixed_rows, fixed_cols}) {
+            return std::variant_alternative_t<I, AnyCraftWorldGameState>(state);
+        }
+        return to_fixed_state<I + 1>(state);
+    } else {
+        return state;
+    }
+}
+}    // namespace
+
+auto make_game_state(std::string_view board_str) -> AnyCraftWorldGameState {
+    return to_fixed_state(CraftWorldGameState(board_str));
+}
+
 }    // namespace craftworld
@@ -1,12 +1,17 @@
 #ifndef CRAFTWORLD_BASE_H_
 #define CRAFTWORLD_BASE_H_
 
+#include <algorithm>
 #include <array>
 #include <iostream>
 #include <memory>
 #include <random>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <variant>
 
 #include "definitions.h"
 
@@ -18,6 +23,145 @@ constexpr int SPRITE_HEIGHT = 32;
 constexpr int SPRITE_CHANNELS = 3;
 constexpr int SPRITE_DATA_LEN_PER_ROW = SPRITE_WIDTH * SPRITE_CHANNELS;
 constexpr int SPRITE_DATA_LEN = SPRITE_WIDTH * SPRITE_HEIGHT * SPRITE_CHANNELS;
+// Tile sizes with a precomputed sprite atlas, each downscaled from the SPRITE_WIDTH sprites
+constexpr std::array<int, 6> kTileSizes{32, 16, 8, 4, 2, 1};
+// Tile drawn as black, used for the image border not covered by inventory items
+constexpr uint8_t kBlankTile = kNumElements;
+
+// Observation properties
+// One value per inventory slot drawn in the border of the full observation, see write_inventory_observation()
+constexpr int kInventoryObservationSize = 10;
+
+// Board storage properties
+// Boards up to CRAFTWORLD_MAX_BOARD_DIM rows/cols are stored inline so states copy without allocating,
+// larger boards are stored on the heap
+#ifndef CRAFTWORLD_MAX_BOARD_DIM
+#define CRAFTWORLD_MAX_BOARD_DIM 32
+#endif
+constexpr int kMaxInlineBoardDim = CRAFTWORLD_MAX_BOARD_DIM;
+// Largest supported rows/cols, as the binary formats store them in a single byte
+constexpr int kMaxBoardDim = 255;
+static_assert(kMaxInlineBoardDim > 0 && kMaxInlineBoardDim <= kMaxBoardDim);
+// Board is padded with a sentinel wall on each side, so neighbours never need a bounds check
+constexpr int kMaxInlinePaddedBoardSize = (kMaxInlineBoardDim + 2) * (kMaxInlineBoardDim + 2);
+
+// Hash properties
+// With CRAFTWORLD_HASH_128, a second 64-bit hash word is maintained on every action for large searches
+#ifndef CRAFTWORLD_HASH_128
+#define CRAFTWORLD_HASH_128 0
+#endif
+constexpr bool kHash128 = CRAFTWORLD_HASH_128 != 0;
+
+struct Hash128 {
+    uint64_t lo = 0;    // Equal to get_hash()
+    uint64_t hi = 0;
+    auto operator==(const Hash128 &other) const noexcept -> bool = default;
+};
+
+// Zobrist keys for one board size, built once and shared by every state of that size
+struct ZobristTable;
+
+// Cells of the padded board, stored inline for boards up to kMaxInlineBoardDim rows/cols and on the heap otherwise.
+// Copies only touch the cells in use, and allocate only for heap boards.
+class BoardCells {
+public:
+    BoardCells() noexcept = default;
+    ~BoardCells() = default;
+
+    BoardCells(const BoardCells &other) {
+        resize(other.num_cells);
+        std::copy_n(other.cells, num_cells, cells);
+    }
+    BoardCells(BoardCells &&other) noexcept {
+        *this = std::move(other);
+    }
+    auto operator=(const BoardCells &other) -> BoardCells & {
+        if (this != &other) {
+            resize(other.num_cells);
+            std::copy_n(other.cells, num_cells, cells);
+        }
+        return *this;
+    }
+    auto operator=(BoardCells &&other) noexcept -> BoardCells & {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.heap_cells) {
+            heap_cells = std::move(other.heap_cells);
+            cells = heap_cells.get();
+            num_cells = other.num_cells;
+        } else {
+            heap_cells.reset();
+            cells = inline_cells.data();
+            num_cells = other.num_cells;
+            std::copy_n(other.cells, num_cells, cells);
+        }
+        other.cells = other.inline_cells.data();
+        other.num_cells = 0;
+        return *this;
+    }
+
+    /**
+     * Set the number of cells, reusing the storage if the size is unchanged. Cell values are left unspecified.
+     * @param size Number of cells of the padded board
+     */
+    void resize(std::size_t size) {
+        if (size <= inline_cells.size()) {
+            heap_cells.reset();
+            cells = inline_cells.data();
+        } else if (!heap_cells || size != num_cells) {
+            heap_cells = std::make_unique_for_overwrite<uint8_t[]>(size);    // NOLINT(*-avoid-c-arrays)
+            cells = heap_cells.get();
+        }
+        num_cells = size;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return num_cells;
+    }
+    [[nodiscard]] auto data() noexcept -> uint8_t * {
+        return cells;
+    }
+    [[nodiscard]] auto data() const noexcept -> const uint8_t * {
+        return cells;
+    }
+    [[nodiscard]] auto begin() noexcept -> uint8_t * {
+        return cells;
+    }
+    [[nodiscard]] auto begin() const noexcept -> const uint8_t * {
+        return cells;
+    }
+    [[nodiscard]] auto end() noexcept -> uint8_t * {
+        return cells + num_cells;
+    }
+    [[nodiscard]] auto end() const noexcept -> const uint8_t * {
+        return cells + num_cells;
+    }
+    auto operator[](std::size_t idx) noexcept -> uint8_t & {
+        return cells[idx];
+    }
+    auto operator[](std::size_t idx) const noexcept -> const uint8_t & {
+        return cells[idx];
+    }
+
+private:
+    uint8_t *cells = inline_cells.data();    // Points into inline_cells or heap_cells
+    std::size_t num_cells = 0;
+    std::unique_ptr<uint8_t[]> heap_cells;    // NOLINT(*-avoid-c-arrays)
+    // Left uninitialized, only the first num_cells are ever read
+    std::array<uint8_t, kMaxInlinePaddedBoardSize> inline_cells;    // NOLINT(*-member-init)
+};
+
+// Binary state encoding from to_bytes(), every integer is little-endian:
+//   0: uint8 format version
+//   1: uint8 rows, uint8 cols, uint8 goal
+//   4: uint32 agent index
+//   8: uint64 reward signal
+//  16: uint8 number of inventory entries, then uint8 element and uint32 count for each nonzero count
+//  then rows * cols uint8 cells in row-major order
+// The hash is recomputed when decoding, and the last action is not stored so update_observation() needs
+// a full write_observation() first.
+constexpr uint8_t kStateBytesVersion = 1;
 
 // Game state
 class CraftWorldGameState {
@@ -34,7 +178,37 @@ public:
         std::unordered_map<int, int> inventory;
     };
 
-    CraftWorldGameState(const std::string &board_str);
+    // Changes made since the last apply_action began, used to patch observations and undo actions
+    struct StepDelta {
+        std::array<int, 2> cells{};                // Padded indices of changed board cells
+        std::array<uint8_t, 2> prev_cells{};       // Elements on those cells before the change
+        int num_cells = 0;
+        uint32_t inventory_mask = 0;               // Bit per element whose inventory count changed
+        std::array<uint8_t, 4> prev_elements{};    // First inventory elements changed
+        std::array<int, 4> prev_counts{};          // Counts of those elements before the change
+        int num_inventory = 0;
+    };
+
+    // Everything needed to revert one action, see apply_action_with_undo()
+    struct UndoRecord {
+        StepDelta delta;
+        uint64_t hash = 0;
+        uint64_t hash_hi = 0;
+        uint64_t reward_signal = 0;
+        uint64_t board_hash = 0;
+        int agent_idx = 0;
+    };
+
+    CraftWorldGameState(std::string_view board_str);
+
+    /**
+     * Create the state from a board of element values, with an empty inventory.
+     * @param rows Number of board rows
+     * @param cols Number of board cols
+     * @param goal Element to reach
+     * @param cells Element value of each cell, in row-major order
+     */
+    CraftWorldGameState(int rows, int cols, Element goal, std::span<const uint8_t> cells);
     CraftWorldGameState(InternalState &&internal_state);
 
     auto operator==(const CraftWorldGameState &other) const noexcept -> bool;
@@ -74,6 +248,28 @@ public:
      */
     void apply_action(Action action);
 
+    /**
+     * Apply the action as apply_action() does, and return a record which can revert it.
+     * @param action The action to apply, should be one of the legal actions
+     * @return Undo record for the action, with no allocation
+     */
+    [[nodiscard]] auto apply_action_with_undo(Action action) -> UndoRecord;
+
+    /**
+     * Revert the action of an undo record, restoring the exact state from before it, including the hash and
+     * reward signal. Records must be undone in reverse order of being applied. Afterwards, update_observation()
+     * patches the observation from after the action back to the one from before it.
+     * @param record Record from apply_action_with_undo() of the most recent action not yet undone
+     */
+    void undo(const UndoRecord &record) noexcept;
+
+    /**
+     * Get the actions which would change the board, inventory or agent position if applied, without applying them.
+     * Matches apply_action() exactly, including the tools needed to mine iron, cross water and remove stone.
+     * @return Bit field with bit i set if Action i would change the state
+     */
+    [[nodiscard]] auto effective_action_mask() const noexcept -> uint8_t;
+
     /**
      * Check if the state is in the solution state (agent inside exit).
      * @return True if terminal, false otherwise
@@ -93,17 +289,115 @@ public:
      */
     [[nodiscard]] auto get_observation() const noexcept -> std::vector<float>;
 
+    /**
+     * Write the flat observation into a caller provided buffer, without allocating.
+     * The buffer is fully overwritten, and should be viewed as the shape given by observation_shape().
+     * @param obs Buffer of size C*H*W from observation_shape()
+     */
+    void write_observation(std::span<float> obs) const;
+
+    /**
+     * Patch an observation buffer using only the board cells and inventory items changed by the last apply_action.
+     * The buffer must hold the observation of this state from before that apply_action, as written by
+     * write_observation() or update_observation(). Costs O(changed cells) rather than O(C*H*W).
+     * @param obs Buffer of size C*H*W from observation_shape()
+     */
+    void update_observation(std::span<float> obs) const;
+
+    /**
+     * Write the flat observation as uint8 values, with the same layout as write_observation().
+     * @param obs Buffer of size C*H*W from observation_shape()
+     */
+    void write_observation_uint8(std::span<uint8_t> obs) const;
+
+    /**
+     * Get the number of bytes of the bit-packed observation.
+     * @return ceil(C*H*W / 8) from observation_shape()
+     */
+    [[nodiscard]] auto packed_observation_size() const noexcept -> int;
+
+    /**
+     * Write the flat observation packed as one bit per value, where bit i of the flat observation
+     * is bit (i % 8) of byte (i / 8). Expand back with unpack_observation().
+     * @param obs Buffer of size packed_observation_size()
+     */
+    void write_observation_packed(std::span<uint8_t> obs) const;
+
+    /**
+     * Get the shape the agent-centred observations should be viewed as, which is independent of the board size.
+     * @param radius Number of cells shown on each side of the agent
+     * @return array indicating observation CHW, with H = W = 2 * radius + 1
+     */
+    [[nodiscard]] constexpr static auto egocentric_observation_shape(int radius) noexcept -> std::array<int, 3> {
+        return {kNumElements, (2 * radius) + 1, (2 * radius) + 1};
+    }
+
+    /**
+     * Get the flat agent-centred observation, a window of the board with the agent in the middle.
+     * Cells outside the board are shown as walls, and the inventory is left out, see get_inventory_observation().
+     * @param radius Number of cells shown on each side of the agent
+     * @return vector where 1 represents element at position, viewed as egocentric_observation_shape(radius)
+     */
+    [[nodiscard]] auto get_egocentric_observation(int radius) const -> std::vector<float>;
+
+    /**
+     * Write the flat agent-centred observation into a caller provided buffer, without allocating.
+     * Costs O(C*(2*radius+1)^2) regardless of the board size.
+     * @param obs Buffer of size C*H*W from egocentric_observation_shape(radius)
+     * @param radius Number of cells shown on each side of the agent
+     */
+    void write_egocentric_observation(std::span<float> obs, int radius) const;
+
+    /**
+     * Get the inventory as shown in the border of the full observation, as a compact vector.
+     * @return vector of kInventoryObservationSize values, 1 if the inventory slot is filled
+     */
+    [[nodiscard]] auto get_inventory_observation() const -> std::vector<float>;
+
+    /**
+     * Write the inventory observation into a caller provided buffer, without allocating.
+     * @param obs Buffer of size kInventoryObservationSize
+     */
+    void write_inventory_observation(std::span<float> obs) const;
+
+    /**
+     * Check if sprites can be rendered at the given tile size.
+     * @param tile_size Tile width/height in pixels
+     * @return True if tile_size is one of kTileSizes, false otherwise
+     */
+    [[nodiscard]] constexpr static auto is_valid_tile_size(int tile_size) noexcept -> bool {
+        return std::find(kTileSizes.begin(), kTileSizes.end(), tile_size) != kTileSizes.end();
+    }
+
     /**
      * Get the shape the image should be viewed as.
+     * @param tile_size Tile width/height in pixels
      * @return array indicating observation HWC
      */
-    [[nodiscard]] auto image_shape() const noexcept -> std::array<int, 3>;
+    [[nodiscard]] auto image_shape(int tile_size = SPRITE_WIDTH) const noexcept -> std::array<int, 3>;
 
     /**
-     * Get the flat (HWC) image representation of the current state
+     * Get the flat (HWC) image representation of the current state.
+     * Inventory items are drawn in the outer border in element order, so equal states give equal images.
+     * @param tile_size Tile width/height in pixels, one of kTileSizes
      * @return flattened byte vector represending RGB values (HWC)
      */
-    [[nodiscard]] auto to_image() const noexcept -> std::vector<uint8_t>;
+    [[nodiscard]] auto to_image(int tile_size = SPRITE_WIDTH) const -> std::vector<uint8_t>;
+
+    /**
+     * Write the flat (HWC) image into a caller provided buffer, without allocating.
+     * The buffer is fully overwritten.
+     * @param img Buffer of size H*W*C from image_shape(tile_size)
+     * @param tile_size Tile width/height in pixels, one of kTileSizes
+     */
+    void write_image(std::span<uint8_t> img, int tile_size = SPRITE_WIDTH) const;
+
+    /**
+     * Write the element drawn at each sprite tile of the image, with kBlankTile for tiles left black.
+     * Tiles are row major over the (rows + 4) x (cols + 4) image tile grid, with inventory items in element order.
+     * @param tiles Buffer of size (rows + 4) * (cols + 4)
+     */
+    void write_tiles(std::span<uint8_t> tiles) const;
 
     /**
      * Get the current reward signal as a result of the previous action taken.
@@ -117,6 +411,13 @@ public:
      */
     [[nodiscard]] auto get_hash() const noexcept -> uint64_t;
 
+    /**
+     * Get the 128-bit hash for the current state, whose low word is get_hash().
+     * This is maintained per action with CRAFTWORLD_HASH_128, and otherwise computed from the whole state.
+     * @return 128-bit hash value
+     */
+    [[nodiscard]] auto get_hash128() const noexcept -> Hash128;
+
     /**
      * Add the given element to the inventory
      */
@@ -135,6 +436,26 @@ public:
      */
     [[nodiscard]] auto get_agent_index() const noexcept -> int;
 
+    /**
+     * Get the goal element which solves the level once in the inventory
+     * @return Goal element
+     */
+    [[nodiscard]] auto get_goal() const noexcept -> Element;
+
+    /**
+     * Get the board dimensions, without the observation/image border
+     * @return array indicating rows, cols
+     */
+    [[nodiscard]] auto get_board_shape() const noexcept -> std::array<int, 2>;
+
+    /**
+     * Get the element at a board index
+     * @param index Flat index into the board, as from get_agent_index()
+     * @return Element at the index
+     * @throws std::invalid_argument if the index is outside the board
+     */
+    [[nodiscard]] auto get_element(int index) const -> Element;
+
     /**
      * Get all indices for a given element type
      * @param element The hidden cell type of the element to search for
@@ -143,53 +464,217 @@ public:
     [[nodiscard]] auto get_indices(Element element) const noexcept -> std::vector<int>;
 
     friend auto operator<<(std::ostream &os, const CraftWorldGameState &state) -> std::ostream &;
+    friend class StateArena;
+    friend class DistanceCache;
+
+    /**
+     * Pack the state for pickling, using the unpadded board layout.
+     * @return Internal state
+     */
+    [[nodiscard]] auto pack() const -> InternalState;
+
+    /**
+     * Encode the state in the binary layout of kStateBytesVersion.
+     * @return Encoded state
+     */
+    [[nodiscard]] auto to_bytes() const -> std::vector<uint8_t>;
+
+    /**
+     * Append the binary encoding of the state, so many states can share one buffer.
+     * @param bytes Buffer to append to
+     */
+    void append_bytes(std::vector<uint8_t> &bytes) const;
+
+    /**
+     * Decode a state from to_bytes().
+     * @param bytes Encoded state, with no trailing bytes
+     * @return Decoded state
+     * @throws std::invalid_argument if the encoding is truncated, invalid or of another version
+     */
+    [[nodiscard]] static auto from_bytes(std::span<const uint8_t> bytes) -> CraftWorldGameState;
+
+    /**
+     * Decode the state at an offset into a buffer from append_bytes().
+     * @param bytes Buffer of encoded states
+     * @param offset Byte offset of the state, advanced past it
+     * @return Decoded state
+     * @throws std::invalid_argument if the encoding is truncated, invalid or of another version
+     */
+    [[nodiscard]] static auto read_bytes(std::span<const uint8_t> bytes, std::size_t &offset)
+        -> CraftWorldGameState;
 
-    [[nodiscard]] auto pack() const -> InternalState {
-        std::vector<int> _grid;
-        std::unordered_map<int, int> _inventory;
-        _grid.reserve(grid.size());
-        for (const auto &el : grid) {
-            _grid.push_back(static_cast<int>(el));
+private:
+    template <int Rows, int Cols>
+    friend class CraftWorldGameStateT;
+
+    // Board geometry helpers take the board size as template arguments, where 0 reads it from the state.
+    // CraftWorldGameStateT instantiates them with fixed sizes, so index arithmetic folds to constants.
+    template <int Cols>
+    [[nodiscard]] auto BoardCols() const noexcept -> int {
+        if constexpr (Cols > 0) {
+            return Cols;
+        } else {
+            return cols;
         }
-        for (const auto &[el, count] : inventory) {
-            _inventory[static_cast<int>(el)] = count;
+    }
+    template <int Cols>
+    [[nodiscard]] auto PaddedCols() const noexcept -> int {
+        if constexpr (Cols > 0) {
+            return Cols + 2;
+        } else {
+            return padded_cols;
+        }
+    }
+    template <int Rows>
+    [[nodiscard]] auto BoardRows() const noexcept -> int {
+        if constexpr (Rows > 0) {
+            return Rows;
+        } else {
+            return rows;
         }
-        return {
-            .rows = rows,
-            .cols = cols,
-            .agent_idx = agent_idx,
-            .grid = _grid,
-            .goal = static_cast<int>(goal),
-            .reward_signal = reward_signal,
-            .hash = hash,
-            .inventory = _inventory,
-        };
     }
 
-private:
+    // What kUse acts on, shared by HandleAgentUse() and EffectiveActionMask()
+    enum class UseKind {
+        kNone,
+        kCollect,    // Collect a primitive, or iron with a bronze pick
+        kCraft,      // Craft at a workshop
+        kBridge,     // Remove water with a bridge
+        kAxe,        // Remove stone with an iron pick
+    };
+    struct UseTarget {
+        UseKind kind = UseKind::kNone;
+        int padded_idx = 0;
+        const RecipeDef *recipe = nullptr;
+    };
+
+    template <int Cols>
+    void ApplyAction(Action action) noexcept;
+    template <int Cols>
+    auto ApplyActionWithUndo(Action action) noexcept -> UndoRecord;
+    template <int Cols>
+    void Undo(const UndoRecord &record) noexcept;
+    void CheckObservationSize(std::size_t size) const;
+    template <int Rows, int Cols, typename ObsT>
+    void WriteObservation(ObsT &obs) const;
+    template <int Rows, int Cols, typename ObsT>
+    void UpdateObservation(ObsT &obs) const;
+    static void CheckBoardSize(int rows, int cols);
+    void InitBoard(int _rows, int _cols, int _goal, std::span<const uint8_t> cells);
+    void InitPaddedGrid(const std::vector<int> &flat_grid);
+    template <int Cols = 0>
     auto IndexFromAction(int index, Action action) const noexcept -> int;
-    auto InBounds(int index, Action action) const noexcept -> bool;
-    auto IsWorkShop(int index) const noexcept -> bool;
-    auto IsPrimitive(int index) const noexcept -> bool;
-    auto IsItem(int index, Element element) const noexcept -> bool;
+    template <int Cols = 0>
+    auto PaddedIndexFromAction(int padded_index, Action action) const noexcept -> int;
+    template <int Cols = 0>
+    auto ToPaddedIndex(int index) const noexcept -> int;
+    template <int Cols = 0>
+    auto FromPaddedIndex(int padded_index) const noexcept -> int;
+    auto GetElement(int padded_index) const noexcept -> Element;
+    auto IsWorkShop(int padded_index) const noexcept -> bool;
+    auto IsPrimitive(int padded_index) const noexcept -> bool;
+    auto IsItem(int padded_index, Element element) const noexcept -> bool;
     auto HasItemInInventory(Element element, int min_count = 1) const noexcept -> bool;
     void RemoveFromInventory(Element element, int count) noexcept;
     void AddToInventory(Element element, int count) noexcept;
-    auto CanCraftItem(RecipeItem recipe_item) const noexcept -> bool;
+    auto CanCraftItem(const RecipeDef &recipe) const noexcept -> bool;
+    template <int Cols>
     void HandleAgentMovement(Action action) noexcept;
+    template <int Cols>
+    [[nodiscard]] auto FindUseTarget() const noexcept -> UseTarget;
+    template <int Cols>
     void HandleAgentUse() noexcept;
-    void RemoveItemFromBoard(int index) noexcept;
+    template <int Cols>
+    [[nodiscard]] auto EffectiveActionMask() const noexcept -> uint8_t;
+    template <int Cols>
+    void RemoveItemFromBoard(int padded_index) noexcept;
+    void RecordCellChange(int padded_index, Element prev_element) noexcept;
+    void RecordInventoryChange(Element element) noexcept;
+    auto ComputeHash() const noexcept -> Hash128;
+    auto ComputeBoardHash() const noexcept -> uint64_t;
+    auto XorCellHash(Element element, int index) noexcept -> uint64_t;
+    void XorInventoryHash(Element element, int from_count, int to_count) noexcept;
 
     int rows{};
     int cols{};
-    int agent_idx{};
-    std::vector<Element> grid;
-    Element goal;
+    int padded_cols{};
+    int agent_idx{};           // Agent index into the unpadded board
+    int agent_padded_idx{};    // Agent index into the padded grid
+    Element goal{};
     uint64_t reward_signal = 0;
     uint64_t hash = 0;
-    std::unordered_map<Element, int> inventory;    // Inventory of items
+    uint64_t hash_hi = 0;                                // Only maintained with CRAFTWORLD_HASH_128
+    // Zobrist hash of the cells with the agent's cell keyed as empty, which only changes when a cell is removed.
+    // Lets caches such as DistanceCache tell boards apart without comparing them.
+    uint64_t board_hash = 0;
+    const ZobristTable *zobrist = nullptr;               // Keys for this board size
+    std::array<int, kNumElements> inventory{};          // Inventory of items, count per element
+    BoardCells grid;                                     // Board padded with sentinel walls
+    StepDelta delta;
 };
 
+/**
+ * Expand a bit-packed observation from write_observation_packed() back to floats.
+ * @param packed Packed observation of size ceil(obs.size() / 8)
+ * @param obs Buffer of size C*H*W to write the observation into
+ */
+void unpack_observation(std::span<const uint8_t> packed, std::span<float> obs);
+
+// Copies of inline boards copy the used cells with no allocation, and moves never allocate
+static_assert(std::is_nothrow_move_constructible_v<CraftWorldGameState>);
+
+// Board sizes (rows, cols) with a CraftWorldGameStateT specialization, covering the bundled problem sets
+// and the default generator map size
+constexpr std::array<std::array<int, 2>, 3> kFixedBoardSizes{{{10, 10}, {14, 14}, {18, 18}}};
+
+[[nodiscard]] constexpr auto is_fixed_board_size(int rows, int cols) noexcept -> bool {
+    return std::find(kFixedBoardSizes.begin(), kFixedBoardSizes.end(), std::array<int, 2>{rows, cols}) !=
+           kFixedBoardSizes.end();
+}
+
+// Game state of a board size known at compile time.
+// Shares all logic and storage with CraftWorldGameState, but steps and writes observations with the
+// board size as a constant, so index arithmetic needs no runtime divides.
+template <int Rows, int Cols>
+class CraftWorldGameStateT : public CraftWorldGameState {
+    static_assert(is_fixed_board_size(Rows, Cols), "Board size must be one of kFixedBoardSizes");
+
+public:
+    /**
+     * Create the state from a board string.
+     * @param board_str Board string of size Rows x Cols
+     * @throws std::invalid_argument if the board is invalid or of another size
+     */
+    explicit CraftWorldGameStateT(std::string_view board_str);
+
+    /**
+     * Create the state from a dynamically sized state.
+     * @param state State of size Rows x Cols
+     * @throws std::invalid_argument if the state is of another size
+     */
+    explicit CraftWorldGameStateT(const CraftWorldGameState &state);
+
+    void apply_action(Action action);
+    [[nodiscard]] auto apply_action_with_undo(Action action) -> UndoRecord;
+    void undo(const UndoRecord &record) noexcept;
+    [[nodiscard]] auto effective_action_mask() const noexcept -> uint8_t;
+    [[nodiscard]] auto get_observation() const noexcept -> std::vector<float>;
+    void write_observation(std::span<float> obs) const;
+    void update_observation(std::span<float> obs) const;
+};
+
+// Any game state from make_game_state(), the dynamically sized state is the fallback
+using AnyCraftWorldGameState = std::variant<CraftWorldGameState, CraftWorldGameStateT<10, 10>,
+                                            CraftWorldGameStateT<14, 14>, CraftWorldGameStateT<18, 18>>;
+
+/**
+ * Create the game state for a board string, using the CraftWorldGameStateT specialization of its size
+ * if there is one. Use with std::visit so calls resolve to the specialized methods.
+ * @param board_str Board string
+ * @return Specialized state if the size is one of kFixedBoardSizes, otherwise CraftWorldGameState
+ */
+[[nodiscard]] auto make_game_state(std::string_view board_str) -> AnyCraftWorldGameState;
+
 }    // namespace craftworld
 
 #endif    // CRAFTWORLD_BASE_H_
@@ -0,0 +1,152 @@
+#include "craftworld_batch.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace craftworld {
+
+namespace {
+auto shape_size(const std::array<int, 3> &shape) noexcept -> std::size_t {
+    return static_cast<std::size_t>(shape[0]) * static_cast<std::size_t>(shape[1]) *
+           static_cast<std::size_t>(shape[2]);
+}
+
+// Shared by the const and mutable batches
+template <typename StatePtr>
+auto checked_observation_shape(std::span<const StatePtr> states) -> std::array<int, 3> {
+    if (states.empty()) {
+        throw std::invalid_argument("At least one state is required.");
+    }
+    const auto shape = states.front()->observation_shape();
+    for (const auto &state : states) {
+        if (state->observation_shape() != shape) {
+            throw std::invalid_argument("All states must have the same rows/cols.");
+        }
+    }
+    return shape;
+}
+}    // namespace
+
+auto batch_observation_shape(std::span<const CraftWorldGameState *const> states) -> std::array<int, 3> {
+    return checked_observation_shape(states);
+}
+
+void step_states(std::span<CraftWorldGameState *const> states, std::span<const int> actions, std::span<float> obs,
+                 std::span<uint64_t> reward_signals, std::span<uint8_t> solved) {
+    const auto obs_size = shape_size(checked_observation_shape<CraftWorldGameState *>(states));
+    if (actions.size() != states.size() || reward_signals.size() != states.size() ||
+        solved.size() != states.size()) {
+        throw std::invalid_argument("Number of actions/outputs does not match number of states.");
+    }
+    if (obs.size() != states.size() * obs_size) {
+        throw std::invalid_argument("Observation buffer size does not match the batch observation size.");
+    }
+    for (const auto &action : actions) {
+        if (!CraftWorldGameState::is_valid_action(static_cast<Action>(action))) {
+            throw std::invalid_argument("Invalid action.");
+        }
+    }
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        auto &state = *states[i];
+        state.apply_action(static_cast<Action>(actions[i]));
+        reward_signals[i] = state.get_reward_signal();
+        solved[i] = static_cast<uint8_t>(state.is_solution());
+        state.write_observation(obs.subspan(i * obs_size, obs_size));
+    }
+}
+
+void write_observations(std::span<const CraftWorldGameState *const> states, std::span<float> obs) {
+    const auto obs_size = shape_size(batch_observation_shape(states));
+    if (obs.size() != states.size() * obs_size) {
+        throw std::invalid_argument("Observation buffer size does not match the batch observation size.");
+    }
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        states[i]->write_observation(obs.subspan(i * obs_size, obs_size));
+    }
+}
+
+void write_egocentric_observations(std::span<const CraftWorldGameState *const> states, std::span<float> obs,
+                                   int radius) {
+    if (radius < 0) {
+        throw std::invalid_argument("Observation radius must be non-negative.");
+    }
+    const auto obs_size = shape_size(CraftWorldGameState::egocentric_observation_shape(radius));
+    if (obs.size() != states.size() * obs_size) {
+        throw std::invalid_argument("Observation buffer size does not match the batch observation size.");
+    }
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        states[i]->write_egocentric_observation(obs.subspan(i * obs_size, obs_size), radius);
+    }
+}
+
+void write_inventory_observations(std::span<const CraftWorldGameState *const> states, std::span<float> obs) {
+    constexpr auto obs_size = static_cast<std::size_t>(kInventoryObservationSize);
+    if (obs.size() != states.size() * obs_size) {
+        throw std::invalid_argument("Inventory observation buffer size does not match the batch size.");
+    }
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        states[i]->write_inventory_observation(obs.subspan(i * obs_size, obs_size));
+    }
+}
+
+void write_images(std::span<const CraftWorldGameState *const> states, std::span<uint8_t> imgs, int tile_size) {
+    if (states.empty()) {
+        throw std::invalid_argument("At least one state is required.");
+    }
+    const auto img_shape = states.front()->image_shape(tile_size);
+    for (const auto *state : states) {
+        if (state->image_shape(tile_size) != img_shape) {
+            throw std::invalid_argument("All states must have the same rows/cols.");
+        }
+    }
+    const auto img_size = shape_size(img_shape);
+    if (imgs.size() != states.size() * img_size) {
+        throw std::invalid_argument("Image buffer size does not match the batch image size.");
+    }
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        states[i]->write_image(imgs.subspan(i * img_size, img_size), tile_size);
+    }
+}
+
+void write_action_masks(std::span<const CraftWorldGameState *const> states, std::span<uint8_t> masks) {
+    if (masks.size() != states.size()) {
+        throw std::invalid_argument("Number of masks does not match number of states.");
+    }
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        masks[i] = states[i]->effective_action_mask();
+    }
+}
+
+auto states_to_bytes(std::span<const CraftWorldGameState> states) -> std::vector<uint8_t> {
+    std::vector<uint8_t> bytes;
+    for (std::size_t i = 0; i < sizeof(uint64_t); ++i) {
+        bytes.push_back(static_cast<uint8_t>(states.size() >> (8 * i)));    // NOLINT(*-magic-numbers)
+    }
+    for (const auto &state : states) {
+        state.append_bytes(bytes);
+    }
+    return bytes;
+}
+
+auto states_from_bytes(std::span<const uint8_t> bytes) -> std::vector<CraftWorldGameState> {
+    if (bytes.size() < sizeof(uint64_t)) {
+        throw std::invalid_argument("Encoded states are truncated.");
+    }
+    uint64_t num_states = 0;
+    for (std::size_t i = 0; i < sizeof(uint64_t); ++i) {
+        num_states |= static_cast<uint64_t>(bytes[i]) << (8 * i);    // NOLINT(*-magic-numbers)
+    }
+    // Every state takes at least one byte, which bounds the reservation for corrupt counts
+    std::vector<CraftWorldGameState> states;
+    states.reserve(std::min<uint64_t>(num_states, bytes.size()));
+    std::size_t offset = sizeof(uint64_t);
+    for (uint64_t i = 0; i < num_states; ++i) {
+        states.push_back(CraftWorldGameState::read_bytes(bytes, offset));
+    }
+    if (offset != bytes.size()) {
+        throw std::invalid_argument("Encoded states have trailing bytes.");
+    }
+    return states;
+}
+
+}    // namespace craftworld
@@ -0,0 +1,92 @@
+#ifndef CRAFTWORLD_BATCH_H_
+#define CRAFTWORLD_BATCH_H_
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+// Batched operations over independently owned states, with outputs stacked into contiguous buffers.
+// Unlike CraftWorldVecEnv, solved states are left as is rather than reset.
+
+/**
+ * Get the observation shape shared by every state in a batch.
+ * @param states Non-empty batch of states, all of the same rows/cols
+ * @return array indicating observation CHW
+ */
+[[nodiscard]] auto batch_observation_shape(std::span<const CraftWorldGameState *const> states)
+    -> std::array<int, 3>;
+
+/**
+ * Apply one action to each state, then write the stacked observations, reward signals and solution flags.
+ * Actions are validated before any state is changed.
+ * @param states Batch of states to step, all of the same rows/cols
+ * @param actions One action per state
+ * @param obs Buffer of size N*C*H*W from batch_observation_shape()
+ * @param reward_signals Buffer of one reward signal per state
+ * @param solved Buffer of one flag per state, 1 if the state is a solution
+ */
+void step_states(std::span<CraftWorldGameState *const> states, std::span<const int> actions, std::span<float> obs,
+                 std::span<uint64_t> reward_signals, std::span<uint8_t> solved);
+
+/**
+ * Write the stacked observations of each state.
+ * @param states Batch of states, all of the same rows/cols
+ * @param obs Buffer of size N*C*H*W from batch_observation_shape()
+ */
+void write_observations(std::span<const CraftWorldGameState *const> states, std::span<float> obs);
+
+/**
+ * Write the stacked agent-centred observations of each state, which may have different rows/cols.
+ * @param states Batch of states
+ * @param obs Buffer of size N*C*H*W from egocentric_observation_shape(radius)
+ * @param radius Number of cells shown on each side of the agent
+ */
+void write_egocentric_observations(std::span<const CraftWorldGameState *const> states, std::span<float> obs,
+                                   int radius);
+
+/**
+ * Write the stacked inventory observations of each state.
+ * @param states Batch of states
+ * @param obs Buffer of size N*kInventoryObservationSize
+ */
+void write_inventory_observations(std::span<const CraftWorldGameState *const> states, std::span<float> obs);
+
+/**
+ * Write the stacked images of each state.
+ * @param states Batch of states, all of the same rows/cols
+ * @param imgs Buffer of size N*H*W*C from image_shape(tile_size) of any state
+ * @param tile_size Width/height of each tile in pixels
+ */
+void write_images(std::span<const CraftWorldGameState *const> states, std::span<uint8_t> imgs,
+                  int tile_size = SPRITE_WIDTH);
+
+/**
+ * Write the effective_action_mask() of each state.
+ * @param states Batch of states
+ * @param masks Buffer of one mask per state
+ */
+void write_action_masks(std::span<const CraftWorldGameState *const> states, std::span<uint8_t> masks);
+
+/**
+ * Encode many states into one buffer: a little-endian uint64 count, then the to_bytes() encoding of each state.
+ * @param states States to encode
+ * @return Encoded states
+ */
+[[nodiscard]] auto states_to_bytes(std::span<const CraftWorldGameState> states) -> std::vector<uint8_t>;
+
+/**
+ * Decode a buffer from states_to_bytes().
+ * @param bytes Encoded states, with no trailing bytes
+ * @return Decoded states, in order
+ * @throws std::invalid_argument if the encoding is truncated, invalid or of another version
+ */
+[[nodiscard]] auto states_from_bytes(std::span<const uint8_t> bytes) -> std::vector<CraftWorldGameState>;
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_BATCH_H_
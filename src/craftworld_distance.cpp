@@ -0,0 +1,96 @@
+#include "craftworld_distance.h"
+
+#include <stdexcept>
+
+namespace craftworld {
+
+namespace {
+// Elements are tracked with one bit each
+static_assert(kNumElements <= 32);
+
+auto is_walkable(uint8_t cell) noexcept -> bool {
+    return cell == static_cast<uint8_t>(Element::kEmpty) || cell == static_cast<uint8_t>(Element::kAgent);
+}
+}    // namespace
+
+auto DistanceCache::distance_to_nearest(const CraftWorldGameState &state, Element element) -> int {
+    return Field(state, element)[static_cast<std::size_t>(state.agent_padded_idx)];
+}
+
+auto DistanceCache::get_distance_field(const CraftWorldGameState &state, Element element) -> std::vector<int> {
+    const auto &field = Field(state, element);
+    std::vector<int> result;
+    result.reserve(static_cast<std::size_t>(state.rows * state.cols));
+    for (int i = 0; i < state.rows * state.cols; ++i) {
+        result.push_back(field[static_cast<std::size_t>(state.ToPaddedIndex(i))]);
+    }
+    return result;
+}
+
+void DistanceCache::clear() noexcept {
+    built_mask = 0;
+    for (auto &field : fields) {
+        field = {};
+    }
+    queue = {};
+}
+
+auto DistanceCache::Field(const CraftWorldGameState &state, Element element) -> const std::vector<int> & {
+    if (!CraftWorldGameState::is_valid_element(element)) {
+        throw std::invalid_argument("Unknown element type.");
+    }
+    // Both change as the agent moves, which does not change the board hash
+    if (element == Element::kAgent || element == Element::kEmpty) {
+        throw std::invalid_argument("Distance target cannot be the agent or empty cells.");
+    }
+    if (built_mask == 0 || state.board_hash != board_hash || state.rows != rows || state.cols != cols) {
+        board_hash = state.board_hash;
+        rows = state.rows;
+        cols = state.cols;
+        built_mask = 0;
+    }
+    const uint32_t bit = 1U << static_cast<uint32_t>(element);
+    if ((built_mask & bit) == 0) {
+        BuildField(state, element);
+        built_mask |= bit;
+    }
+    return fields[static_cast<std::size_t>(element)];
+}
+
+void DistanceCache::BuildField(const CraftWorldGameState &state, Element element) {
+    const auto padded_size = static_cast<std::size_t>((state.rows + 2) * state.padded_cols);
+    auto &field = fields[static_cast<std::size_t>(element)];
+    field.assign(padded_size, kUnreachable);
+    queue.resize(padded_size);
+    const std::array<int, 4> offsets{-state.padded_cols, 1, state.padded_cols, -1};
+
+    // Multi-source BFS from every walkable cell beside the element, sentinel walls keep neighbours in bounds
+    std::size_t tail = 0;
+    const auto target = static_cast<uint8_t>(element);
+    for (int i = 0; i < state.rows * state.cols; ++i) {
+        const int padded_idx = state.ToPaddedIndex(i);
+        if (!is_walkable(state.grid[static_cast<std::size_t>(padded_idx)])) {
+            continue;
+        }
+        for (const auto &offset : offsets) {
+            if (state.grid[static_cast<std::size_t>(padded_idx + offset)] == target) {
+                field[static_cast<std::size_t>(padded_idx)] = 0;
+                queue[tail++] = padded_idx;
+                break;
+            }
+        }
+    }
+    for (std::size_t head = 0; head < tail; ++head) {
+        const int padded_idx = queue[head];
+        const int dist = field[static_cast<std::size_t>(padded_idx)] + 1;
+        for (const auto &offset : offsets) {
+            const auto neighbour_idx = static_cast<std::size_t>(padded_idx + offset);
+            if (field[neighbour_idx] == kUnreachable && is_walkable(state.grid[neighbour_idx])) {
+                field[neighbour_idx] = dist;
+                queue[tail++] = static_cast<int>(neighbour_idx);
+            }
+        }
+    }
+}
+
+}    // namespace craftworld
@@ -0,0 +1,59 @@
+#ifndef CRAFTWORLD_DISTANCE_H_
+#define CRAFTWORLD_DISTANCE_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+// Distance given when no cell beside the element can be reached
+constexpr int kUnreachable = -1;
+
+// Distance fields over the walkable cells of a board, one per target element, built lazily on first query.
+// Walls, water, stone and items only leave the board, so the fields stay valid as the agent moves and are
+// rebuilt only once a cell is removed or the cache is queried with a state of another board, told apart by
+// the board hash of the state rather than by comparing cells.
+// A cache is not thread safe, use one per thread.
+class DistanceCache {
+public:
+    /**
+     * Get the number of moves the agent needs to stand beside the nearest cell holding the element,
+     * which is 0 if it already is. O(1) once the field of the element is built for the board.
+     * The board edge counts as kWall.
+     * @param state State to measure from
+     * @param element Element to reach, other than kAgent and kEmpty
+     * @return Number of moves, or kUnreachable if no cell beside the element can be reached
+     */
+    [[nodiscard]] auto distance_to_nearest(const CraftWorldGameState &state, Element element) -> int;
+
+    /**
+     * Get the distance field of an element, as the distance_to_nearest() the agent would have from each cell.
+     * @param state State to measure on
+     * @param element Element to reach, other than kAgent and kEmpty
+     * @return Distance for each cell in row-major order, kUnreachable for cells the agent cannot stand on
+     */
+    [[nodiscard]] auto get_distance_field(const CraftWorldGameState &state, Element element) -> std::vector<int>;
+
+    /**
+     * Drop every field, releasing their memory.
+     */
+    void clear() noexcept;
+
+private:
+    auto Field(const CraftWorldGameState &state, Element element) -> const std::vector<int> &;
+    void BuildField(const CraftWorldGameState &state, Element element);
+
+    uint64_t board_hash = 0;                              // Board the fields were built for, if any are built
+    int rows = 0;                                         // Shape of that board, as boards of other shapes
+    int cols = 0;                                         // can share a hash
+    uint32_t built_mask = 0;                              // Bit per element whose field is built
+    std::array<std::vector<int>, kNumElements> fields;    // Distance per padded grid index
+    std::vector<int> queue;                               // Reused BFS queue
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_DISTANCE_H_
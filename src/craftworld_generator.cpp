@@ -0,0 +1,328 @@
+#include "craftworld_generator.h"
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "craftworld_solver.h"
+#include "definitions.h"
+#include "thread_pool.h"
+
+namespace craftworld {
+
+namespace {
+// Placements for one level are retried this many times before the options are deemed impossible
+constexpr int kMaxGenerateAttempts = 1000;
+
+struct Ingredient {
+    Element element;
+    int count;
+};
+
+// Items placed for each goal in kGeneratorGoals, which cover every step of the crafting chain
+constexpr std::array<std::array<Ingredient, 4>, kGeneratorGoals.size()> kGoalIngredients{{
+    {{{Element::kCopper, 1}, {Element::kTin, 1}, {Element::kWood, 1}, {Element::kEmpty, 0}}},
+    {{{Element::kIron, 1}, {Element::kWood, 2}, {Element::kCopper, 1}, {Element::kTin, 1}}},
+    {{{Element::kIron, 1}, {Element::kWood, 2}, {Element::kCopper, 1}, {Element::kTin, 1}}},
+}};
+constexpr std::array<Element, 4> kGeneratorWorkshops{Element::kWorkshop1, Element::kWorkshop2, Element::kWorkshop3,
+                                                     Element::kFurnace};
+constexpr std::array<Element, 2> kGeneratorPrimitives{Element::kGrass, Element::kWood};
+
+struct Layout {
+    Element goal;
+    std::vector<uint8_t> cells;
+};
+
+// Row-major board being laid out, tracking what is near each cell so free cells are found in one pass
+class LayoutGrid {
+public:
+    explicit LayoutGrid(int size)
+        : size(size),
+          cells(static_cast<std::size_t>(size * size), static_cast<uint8_t>(Element::kEmpty)),
+          occupied_near(cells.size(), 0),
+          workshops_near(cells.size(), 0) {}
+
+    [[nodiscard]] auto get(int r, int c) const noexcept -> Element {
+        return static_cast<Element>(cells[static_cast<std::size_t>(r * size + c)]);
+    }
+
+    void set(int r, int c, Element el) noexcept {
+        const Element prev = get(r, c);
+        const int occupied_change = static_cast<int>(el != Element::kEmpty) - static_cast<int>(prev != Element::kEmpty);
+        const int workshop_change = static_cast<int>(kIsWorkShop[static_cast<std::size_t>(el)]) -
+                                    static_cast<int>(kIsWorkShop[static_cast<std::size_t>(prev)]);
+        AddNear(occupied_near, r, c, 1, occupied_change);
+        AddNear(workshops_near, r, c, 2, workshop_change);
+        cells[static_cast<std::size_t>(r * size + c)] = static_cast<uint8_t>(el);
+    }
+
+    // Empty 3x3 block around the cell with no workshop beside any of it, i.e. no workshop within 2 cells
+    [[nodiscard]] auto has_space_around(int idx) const noexcept -> bool {
+        return occupied_near[static_cast<std::size_t>(idx)] == 0 && workshops_near[static_cast<std::size_t>(idx)] == 0;
+    }
+
+    int size;
+    std::vector<uint8_t> cells;
+
+private:
+    void AddNear(std::vector<int> &counts, int r, int c, int radius, int change) noexcept {
+        if (change == 0) {
+            return;
+        }
+        for (int nr = std::max(r - radius, 0); nr <= std::min(r + radius, size - 1); ++nr) {
+            for (int nc = std::max(c - radius, 0); nc <= std::min(c + radius, size - 1); ++nc) {
+                counts[static_cast<std::size_t>(nr * size + nc)] += change;
+            }
+        }
+    }
+
+    std::vector<int> occupied_near;     // Non-empty cells in the 3x3 block around each cell
+    std::vector<int> workshops_near;    // Workshops in the 5x5 block around each cell
+};
+
+auto uniform_index(std::mt19937_64 &rng, std::size_t n) -> std::size_t {
+    // Modulo bias is below 2^-50 for any board size
+    return static_cast<std::size_t>(rng() % n);
+}
+
+auto sample_goal(std::mt19937_64 &rng, const std::array<double, 3> &probs) -> std::size_t {
+    double total = 0;
+    for (const auto &p : probs) {
+        total += p;
+    }
+    const double u = static_cast<double>(rng() >> 11) * 0x1.0p-53 * total;    // NOLINT(*-magic-numbers)
+    double cumulative = 0;
+    for (std::size_t i = 0; i < probs.size(); ++i) {
+        cumulative += probs[i];
+        if (u < cumulative && probs[i] > 0) {
+            return i;
+        }
+    }
+    // Rounding at the top end, take the last goal with any probability
+    std::size_t last = 0;
+    for (std::size_t i = 0; i < probs.size(); ++i) {
+        if (probs[i] > 0) {
+            last = i;
+        }
+    }
+    return last;
+}
+
+// Random empty cell with free space around it, or none if the board is too full
+auto random_free_extra_space(const LayoutGrid &grid, std::mt19937_64 &rng) -> std::optional<int> {
+    std::size_t num_candidates = 0;
+    for (int idx = 0; idx < grid.size * grid.size; ++idx) {
+        num_candidates += static_cast<std::size_t>(grid.has_space_around(idx));
+    }
+    if (num_candidates == 0) {
+        return std::nullopt;
+    }
+    // Take the chosen candidate in row-major order
+    auto choice = uniform_index(rng, num_candidates);
+    for (int idx = 0;; ++idx) {
+        if (grid.has_space_around(idx) && choice-- == 0) {
+            return idx;
+        }
+    }
+}
+
+// Random empty cell off the board edge, so the treasure can be walled in
+auto random_treasure_location(const LayoutGrid &grid, std::mt19937_64 &rng) -> std::optional<int> {
+    std::vector<int> candidates;
+    for (int r = 1; r < grid.size - 1; ++r) {
+        for (int c = 1; c < grid.size - 1; ++c) {
+            if (grid.get(r, c) == Element::kEmpty) {
+                candidates.push_back(r * grid.size + c);
+            }
+        }
+    }
+    if (candidates.empty()) {
+        return std::nullopt;
+    }
+    return candidates[uniform_index(rng, candidates.size())];
+}
+
+auto try_layout(const GeneratorOptions &options, std::mt19937_64 &rng) -> std::optional<Layout> {
+    const int size = options.map_size;
+    LayoutGrid grid(size);
+    const auto goal_idx = sample_goal(rng, options.goal_probs);
+    const Element goal = kGeneratorGoals[goal_idx];
+
+    // Water moats splitting the board
+    if (options.hard) {
+        const int mid = size / 2;
+        for (int i = 0; i < mid - 2; ++i) {
+            grid.set(mid, i, Element::kWater);
+            grid.set(i, mid, Element::kWater);
+            grid.set(mid, size - i - 1, Element::kWater);
+            grid.set(size - i - 1, mid, Element::kWater);
+        }
+    }
+
+    // Gem in a stone cave
+    if (goal == Element::kGemRing) {
+        const auto treasure = random_treasure_location(grid, rng);
+        if (!treasure) {
+            return std::nullopt;
+        }
+        const int r = *treasure / size;
+        const int c = *treasure % size;
+        grid.set(r, c, Element::kGem);
+        grid.set(r - 1, c, Element::kStone);
+        grid.set(r + 1, c, Element::kStone);
+        grid.set(r, c - 1, Element::kStone);
+        grid.set(r, c + 1, Element::kStone);
+    }
+
+    // Place each element on a free cell
+    const auto place = [&](Element el) -> bool {
+        const auto idx = random_free_extra_space(grid, rng);
+        if (idx) {
+            grid.set(*idx / size, *idx % size, el);
+        }
+        return idx.has_value();
+    };
+
+    // Ingredients required for the goal
+    for (const auto &ingredient : kGoalIngredients[goal_idx]) {
+        for (int i = 0; i < ingredient.count; ++i) {
+            if (!place(ingredient.element)) {
+                return std::nullopt;
+            }
+        }
+    }
+    // Other random ingredients to confuse
+    for (int i = 0; i < options.num_primitive; ++i) {
+        if (!place(kGeneratorPrimitives[uniform_index(rng, kGeneratorPrimitives.size())])) {
+            return std::nullopt;
+        }
+    }
+    // Crafting stations, agent, then random grass for complexity
+    for (const auto &workshop : kGeneratorWorkshops) {
+        if (!place(workshop)) {
+            return std::nullopt;
+        }
+    }
+    if (!place(Element::kAgent)) {
+        return std::nullopt;
+    }
+    for (int i = 0; i < options.num_grass; ++i) {
+        if (!place(Element::kGrass)) {
+            return std::nullopt;
+        }
+    }
+    return Layout{goal, std::move(grid.cells)};
+}
+
+void check_options(const GeneratorOptions &options) {
+    if (options.map_size < 3 || options.map_size > kMaxBoardDim) {
+        throw std::invalid_argument("map_size must be in the range [3, " + std::to_string(kMaxBoardDim) + "].");
+    }
+    double total = 0;
+    for (const auto &p : options.goal_probs) {
+        if (p < 0) {
+            throw std::invalid_argument("Goal probabilities must be non-negative.");
+        }
+        total += p;
+    }
+    if (total <= 0) {
+        throw std::invalid_argument("At least one goal probability must be positive.");
+    }
+    if (options.num_primitive < 0 || options.num_grass < 0) {
+        throw std::invalid_argument("Number of random elements must be non-negative.");
+    }
+}
+
+auto generate_layout(const GeneratorOptions &options, uint64_t seed) -> Layout {
+    std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};    // NOLINT(*-magic-numbers)
+    std::mt19937_64 rng(seq);
+    for (int attempt = 0; attempt < kMaxGenerateAttempts; ++attempt) {
+        auto layout = try_layout(options, rng);
+        if (!layout) {
+            continue;
+        }
+        if (options.require_solvable) {
+            const CraftWorldGameState state(options.map_size, options.map_size, layout->goal, layout->cells);
+            // A* needs the fewest expansions, so fewest solvable levels are rejected at the expansion limit
+            const auto result = solve(state, {.algorithm = SearchAlgorithm::kAStar,
+                                              .max_expansions = options.solver_max_expansions});
+            if (result.status != SolverStatus::kSolved) {
+                continue;
+            }
+        }
+        return std::move(*layout);
+    }
+    throw std::invalid_argument("Unable to generate a level after " + std::to_string(kMaxGenerateAttempts) +
+                                " attempts, map_size may be too small for the options.");
+}
+
+auto to_board_str(const GeneratorOptions &options, const Layout &layout) -> std::string {
+    std::string board_str = std::to_string(options.map_size) + "|" + std::to_string(options.map_size) + "|" +
+                            std::to_string(static_cast<int>(layout.goal));
+    board_str.reserve(board_str.size() + layout.cells.size() * 3);
+    for (const auto &el : layout.cells) {
+        board_str += '|';
+        board_str += static_cast<char>('0' + el / 10);    // NOLINT(*-magic-numbers)
+        board_str += static_cast<char>('0' + el % 10);    // NOLINT(*-magic-numbers)
+    }
+    return board_str;
+}
+
+// Generate each level in parallel, seeding level i with seed + i
+template <typename T, typename MakeT>
+auto generate_parallel(const GeneratorOptions &options, int num_levels, uint64_t seed, int num_threads,
+                       MakeT make) -> std::vector<T> {
+    check_options(options);
+    if (num_levels < 0) {
+        throw std::invalid_argument("Number of levels must be non-negative.");
+    }
+    std::vector<std::optional<T>> levels(static_cast<std::size_t>(num_levels));
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    ThreadPool pool(num_threads);
+    pool.parallel_for(levels.size(), [&](std::size_t begin, std::size_t end) {
+        try {
+            for (std::size_t i = begin; i < end; ++i) {
+                levels[i].emplace(make(generate_layout(options, seed + i)));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            error = std::current_exception();
+        }
+    });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    std::vector<T> result;
+    result.reserve(levels.size());
+    for (auto &level : levels) {
+        result.push_back(std::move(*level));
+    }
+    return result;
+}
+}    // namespace
+
+auto generate_board_str(const GeneratorOptions &options, uint64_t seed) -> std::string {
+    check_options(options);
+    return to_board_str(options, generate_layout(options, seed));
+}
+
+auto generate_board_strs(const GeneratorOptions &options, int num_levels, uint64_t seed, int num_threads)
+    -> std::vector<std::string> {
+    return generate_parallel<std::string>(options, num_levels, seed, num_threads,
+                                          [&](const Layout &layout) { return to_board_str(options, layout); });
+}
+
+auto generate_levels(const GeneratorOptions &options, int num_levels, uint64_t seed, int num_threads)
+    -> std::vector<CraftWorldGameState> {
+    return generate_parallel<CraftWorldGameState>(options, num_levels, seed, num_threads, [&](const Layout &layout) {
+        return CraftWorldGameState(options.map_size, options.map_size, layout.goal, layout.cells);
+    });
+}
+
+}    // namespace craftworld
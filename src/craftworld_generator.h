@@ -0,0 +1,67 @@
+#ifndef CRAFTWORLD_GENERATOR_H_
+#define CRAFTWORLD_GENERATOR_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+// Goals levels are generated for, sampled with GeneratorOptions::goal_probs
+constexpr std::array<Element, 3> kGeneratorGoals{Element::kBronzePick, Element::kIronPick, Element::kGemRing};
+
+// Goal probabilities for the level sets made by scripts/scenario_create.py
+constexpr std::array<double, 3> kGoalProbsTrain{0.2, 0.3, 0.5};
+constexpr std::array<double, 3> kGoalProbsTrainHard{0.3, 0.7, 0.0};
+constexpr std::array<double, 3> kGoalProbsTest{0.0, 0.0, 1.0};
+constexpr std::array<double, 3> kGoalProbsTestHard{0.0, 1.0, 0.0};
+
+struct GeneratorOptions {
+    int map_size = 10;                                     // Board rows and cols
+    std::array<double, 3> goal_probs = kGoalProbsTrain;    // Probability of each goal in kGeneratorGoals
+    bool hard = false;                                     // Split the board with water moats
+    int num_primitive = 0;                                 // Extra grass/wood to confuse
+    int num_grass = 0;                                     // Extra grass for complexity
+    bool require_solvable = false;                         // Resample levels the solver can't solve
+    int64_t solver_max_expansions = 0;                     // Expansion limit when checking solvability, 0 for none
+};
+
+/**
+ * Generate one level with the layout rules of scripts/scenario_create.py.
+ * Ingredients, workshops and the agent are placed on empty cells with no neighbouring element and no workshop
+ * within 2 cells, and the gem ring is placed in a cave of stone. Layouts which run out of space are resampled.
+ * @param options Generation options
+ * @param seed Seed for this level, the same seed always gives the same level
+ * @return Board string of the level
+ */
+[[nodiscard]] auto generate_board_str(const GeneratorOptions &options, uint64_t seed) -> std::string;
+
+/**
+ * Generate levels across a thread pool. Level i is generate_board_str(options, seed + i),
+ * so the levels do not depend on the number of threads.
+ * @param options Generation options
+ * @param num_levels Number of levels
+ * @param seed Seed for the set of levels
+ * @param num_threads Number of threads, including the calling thread
+ * @return Board string of each level
+ */
+[[nodiscard]] auto generate_board_strs(const GeneratorOptions &options, int num_levels, uint64_t seed,
+                                       int num_threads = 1) -> std::vector<std::string>;
+
+/**
+ * Generate levels across a thread pool, see generate_board_strs().
+ * @param options Generation options
+ * @param num_levels Number of levels
+ * @param seed Seed for the set of levels
+ * @param num_threads Number of threads, including the calling thread
+ * @return State of each level
+ */
+[[nodiscard]] auto generate_levels(const GeneratorOptions &options, int num_levels, uint64_t seed,
+                                   int num_threads = 1) -> std::vector<CraftWorldGameState>;
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_GENERATOR_H_
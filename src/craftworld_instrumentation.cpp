@@ -0,0 +1,100 @@
+#include "craftworld_instrumentation.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace craftworld {
+
+namespace {
+// Live threads are summed on read, and exited threads are folded into retired so their counts are kept
+struct Registry {
+    std::mutex mutex;
+    std::vector<const detail::ThreadInstrumentation *> threads;
+    InstrumentationSnapshot retired;
+    InstrumentationSnapshot baseline;    // Totals at the last reset
+};
+
+auto registry() -> Registry & {
+    static Registry instance;
+    return instance;
+}
+
+void accumulate(InstrumentationSnapshot &totals, const detail::ThreadInstrumentation &values) {
+    for (std::size_t i = 0; i < kNumCounters; ++i) {
+        totals.counters[i] += values.counters[i].load(std::memory_order_relaxed);
+    }
+    for (std::size_t i = 0; i < kNumTimers; ++i) {
+        totals.timer_calls[i] += values.timer_calls[i].load(std::memory_order_relaxed);
+        totals.timer_ns[i] += values.timer_ns[i].load(std::memory_order_relaxed);
+    }
+}
+
+// Caller holds the registry mutex
+auto totals_locked(const Registry &reg) -> InstrumentationSnapshot {
+    auto totals = reg.retired;
+    for (const auto *values : reg.threads) {
+        accumulate(totals, *values);
+    }
+    return totals;
+}
+
+constexpr std::array<std::string_view, kNumCounters> kCounterNames{
+    "action_up",  "action_right", "action_down", "action_left", "action_use",  "blocked_moves",
+    "no_op_uses", "collects",     "crafts",      "bridge_uses", "axe_uses",    "hash_updates",
+};
+
+constexpr std::array<std::string_view, kNumTimers> kTimerNames{
+    "apply_action",
+    "write_observation",
+    "update_observation",
+    "write_egocentric_observation",
+    "write_image",
+};
+}    // namespace
+
+namespace detail {
+ThreadInstrumentation::ThreadInstrumentation() {
+    auto &reg = registry();
+    const std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.threads.push_back(this);
+}
+
+ThreadInstrumentation::~ThreadInstrumentation() {
+    auto &reg = registry();
+    const std::lock_guard<std::mutex> lock(reg.mutex);
+    accumulate(reg.retired, *this);
+    reg.threads.erase(std::find(reg.threads.begin(), reg.threads.end(), this));
+}
+}    // namespace detail
+
+auto get_instrumentation() -> InstrumentationSnapshot {
+    auto &reg = registry();
+    const std::lock_guard<std::mutex> lock(reg.mutex);
+    auto totals = totals_locked(reg);
+    for (std::size_t i = 0; i < kNumCounters; ++i) {
+        totals.counters[i] -= reg.baseline.counters[i];
+    }
+    for (std::size_t i = 0; i < kNumTimers; ++i) {
+        totals.timer_calls[i] -= reg.baseline.timer_calls[i];
+        totals.timer_ns[i] -= reg.baseline.timer_ns[i];
+    }
+    return totals;
+}
+
+void reset_instrumentation() {
+    // Threads never have their values written by others, so a reset records a baseline to subtract instead
+    auto &reg = registry();
+    const std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.baseline = totals_locked(reg);
+}
+
+auto counter_name(Counter counter) noexcept -> std::string_view {
+    return kCounterNames[static_cast<std::size_t>(counter)];
+}
+
+auto timer_name(Timer timer) noexcept -> std::string_view {
+    return kTimerNames[static_cast<std::size_t>(timer)];
+}
+
+}    // namespace craftworld
@@ -0,0 +1,146 @@
+#ifndef CRAFTWORLD_INSTRUMENTATION_H_
+#define CRAFTWORLD_INSTRUMENTATION_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace craftworld {
+
+// Instrumentation properties
+// With CRAFTWORLD_INSTRUMENTATION, hot paths count events and time the public entry points.
+// Otherwise every hook compiles to nothing.
+#ifndef CRAFTWORLD_INSTRUMENTATION
+#define CRAFTWORLD_INSTRUMENTATION 0
+#endif
+constexpr bool kInstrumentation = CRAFTWORLD_INSTRUMENTATION != 0;
+
+enum class Counter {
+    kActionUp = 0,    // Actions applied, one counter per Action in the same order
+    kActionRight,
+    kActionDown,
+    kActionLeft,
+    kActionUse,
+    kBlockedMoves,    // Moves onto a non-empty cell
+    kNoOpUses,        // Uses with nothing to act on
+    kCollects,        // Primitives collected, including iron
+    kCrafts,
+    kBridgeUses,
+    kAxeUses,
+    kHashUpdates,    // Zobrist keys applied to the hash
+    kNumCounters,
+};
+
+enum class Timer {
+    kApplyAction = 0,    // apply_action() and apply_action_with_undo()
+    kWriteObservation,   // Every full observation write, including get_observation()
+    kUpdateObservation,
+    kWriteEgocentricObservation,
+    kWriteImage,    // Every image write, including to_image()
+    kNumTimers,
+};
+
+constexpr auto kNumCounters = static_cast<std::size_t>(Counter::kNumCounters);
+constexpr auto kNumTimers = static_cast<std::size_t>(Timer::kNumTimers);
+
+struct InstrumentationSnapshot {
+    std::array<uint64_t, kNumCounters> counters{};
+    std::array<uint64_t, kNumTimers> timer_calls{};
+    std::array<uint64_t, kNumTimers> timer_ns{};
+};
+
+/**
+ * Get the totals across all threads since the last reset_instrumentation().
+ * All zero unless built with CRAFTWORLD_INSTRUMENTATION.
+ * @return Counter and timer totals
+ */
+[[nodiscard]] auto get_instrumentation() -> InstrumentationSnapshot;
+
+/**
+ * Start the totals from zero again.
+ */
+void reset_instrumentation();
+
+/**
+ * Get the name of a counter, as used by the Python bindings.
+ * @param counter Counter to name
+ * @return Name of the counter
+ */
+[[nodiscard]] auto counter_name(Counter counter) noexcept -> std::string_view;
+
+/**
+ * Get the name of a timer, as used by the Python bindings.
+ * @param timer Timer to name
+ * @return Name of the timer
+ */
+[[nodiscard]] auto timer_name(Timer timer) noexcept -> std::string_view;
+
+namespace detail {
+// Values of one thread, only written by that thread so relaxed load/store pairs are enough
+struct ThreadInstrumentation {
+    std::array<std::atomic<uint64_t>, kNumCounters> counters{};
+    std::array<std::atomic<uint64_t>, kNumTimers> timer_calls{};
+    std::array<std::atomic<uint64_t>, kNumTimers> timer_ns{};
+    ThreadInstrumentation();
+    ~ThreadInstrumentation();
+    ThreadInstrumentation(const ThreadInstrumentation &) = delete;
+    ThreadInstrumentation(ThreadInstrumentation &&) = delete;
+    auto operator=(const ThreadInstrumentation &) -> ThreadInstrumentation & = delete;
+    auto operator=(ThreadInstrumentation &&) -> ThreadInstrumentation & = delete;
+};
+
+inline auto thread_instrumentation() -> ThreadInstrumentation & {
+    thread_local ThreadInstrumentation values;
+    return values;
+}
+
+inline void add(std::atomic<uint64_t> &value, uint64_t amount) noexcept {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+}    // namespace detail
+
+/**
+ * Count an event, a no-op unless built with CRAFTWORLD_INSTRUMENTATION.
+ * @param counter Counter to increment
+ * @param amount Amount to add
+ */
+inline void count_event([[maybe_unused]] Counter counter, [[maybe_unused]] uint64_t amount = 1) noexcept {
+    if constexpr (kInstrumentation) {
+        detail::add(detail::thread_instrumentation().counters[static_cast<std::size_t>(counter)], amount);
+    }
+}
+
+// Adds the time until the end of its scope to a timer, empty unless built with CRAFTWORLD_INSTRUMENTATION
+template <bool Enabled = kInstrumentation>
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Timer) noexcept {}
+};
+
+template <>
+class ScopedTimer<true> {
+public:
+    explicit ScopedTimer(Timer timer) noexcept : timer(timer), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        auto &values = detail::thread_instrumentation();
+        const auto idx = static_cast<std::size_t>(timer);
+        detail::add(values.timer_calls[idx], 1);
+        detail::add(values.timer_ns[idx],
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer(ScopedTimer &&) = delete;
+    auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+    auto operator=(ScopedTimer &&) -> ScopedTimer & = delete;
+
+private:
+    Timer timer;
+    std::chrono::steady_clock::time_point start;
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_INSTRUMENTATION_H_
@@ -0,0 +1,267 @@
+#include "craftworld_levels.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+
+#include "thread_pool.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CRAFTWORLD_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace craftworld {
+
+namespace {
+struct LevelLine {
+    std::string_view board_str;
+    int line_num;
+};
+
+auto read_file(const std::string &path) -> std::string {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    std::string contents(static_cast<std::size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    if (!file.read(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+        throw std::invalid_argument("Unable to read " + path);
+    }
+    return contents;
+}
+
+// Non-blank lines of the file, without line endings
+auto split_lines(std::string_view contents) -> std::vector<LevelLine> {
+    std::vector<LevelLine> lines;
+    int line_num = 1;
+    for (std::size_t pos = 0; pos < contents.size(); ++line_num) {
+        const auto end = std::min(contents.find('\n', pos), contents.size());
+        auto line = contents.substr(pos, end - pos);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            lines.push_back({line, line_num});
+        }
+        pos = end + 1;
+    }
+    return lines;
+}
+
+constexpr std::array<char, 4> kLevelPackMagic{'C', 'W', 'L', 'P'};
+constexpr std::size_t kLevelPackHeaderSize = 24;
+constexpr std::size_t kLevelRecordHeaderSize = 3;
+
+void write_le(std::ofstream &file, uint64_t value, int num_bytes) {
+    std::array<char, sizeof(uint64_t)> bytes{};
+    for (int i = 0; i < num_bytes; ++i) {
+        bytes[static_cast<std::size_t>(i)] = static_cast<char>((value >> (8 * i)) & 0xFF);    // NOLINT(*-magic-numbers)
+    }
+    file.write(bytes.data(), num_bytes);
+}
+
+auto read_le(const uint8_t *data, int num_bytes) noexcept -> uint64_t {
+    uint64_t value = 0;
+    for (int i = 0; i < num_bytes; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);    // NOLINT(*-magic-numbers)
+    }
+    return value;
+}
+
+auto make_error(const LevelLine &line, const std::exception &e) -> std::invalid_argument {
+    return std::invalid_argument("line " + std::to_string(line.line_num) + ": " + e.what());
+}
+}    // namespace
+
+auto load_levels(const std::string &path, int num_threads) -> std::vector<CraftWorldGameState> {
+    const auto contents = read_file(path);
+    const auto lines = split_lines(contents);
+    if (lines.empty()) {
+        return {};
+    }
+
+    // States have no empty form, so the first level fills the vector before the rest are parsed into place
+    std::vector<CraftWorldGameState> states = [&]() {
+        try {
+            return std::vector<CraftWorldGameState>(lines.size(), CraftWorldGameState(lines[0].board_str));
+        } catch (const std::invalid_argument &e) {
+            throw make_error(lines[0], e);
+        }
+    }();
+
+    // Report the earliest invalid line, regardless of which thread finds it first
+    std::mutex error_mutex;
+    std::size_t error_idx = std::numeric_limits<std::size_t>::max();
+    std::string error_msg;
+    ThreadPool pool(num_threads);
+    pool.parallel_for(lines.size() - 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin + 1; i < end + 1; ++i) {
+            try {
+                states[i] = CraftWorldGameState(lines[i].board_str);
+            } catch (const std::invalid_argument &e) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (i < error_idx) {
+                    error_idx = i;
+                    error_msg = make_error(lines[i], e).what();
+                }
+                return;
+            }
+        }
+    });
+    if (!error_msg.empty()) {
+        throw std::invalid_argument(error_msg);
+    }
+    return states;
+}
+
+LevelPackWriter::LevelPackWriter(const std::string &path) : file(path, std::ios::binary | std::ios::trunc) {
+    if (!file) {
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    // Header is rewritten by finish() once the index location is known
+    file.write(kLevelPackMagic.data(), kLevelPackMagic.size());
+    write_le(file, kLevelPackVersion, 4);
+    write_le(file, 0, 8);
+    write_le(file, 0, 8);
+    offset = kLevelPackHeaderSize;
+}
+
+LevelPackWriter::~LevelPackWriter() {
+    try {
+        finish();
+    } catch (...) {    // NOLINT(*-empty-catch)
+        // Destructor can't report the failure, call finish() to see it
+    }
+}
+
+void LevelPackWriter::add(const CraftWorldGameState &state) {
+    if (finished) {
+        throw std::invalid_argument("Level pack is already finished.");
+    }
+    const auto packed = state.pack();
+    if (!packed.inventory.empty()) {
+        throw std::invalid_argument("Level packs only store levels with an empty inventory.");
+    }
+    offsets.push_back(offset);
+    write_le(file, static_cast<uint64_t>(packed.rows), 1);
+    write_le(file, static_cast<uint64_t>(packed.cols), 1);
+    write_le(file, static_cast<uint64_t>(packed.goal), 1);
+    std::vector<char> cells(packed.grid.begin(), packed.grid.end());
+    file.write(cells.data(), static_cast<std::streamsize>(cells.size()));
+    offset += kLevelRecordHeaderSize + cells.size();
+}
+
+void LevelPackWriter::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    for (const auto &level_offset : offsets) {
+        write_le(file, level_offset, 8);
+    }
+    file.seekp(8);
+    write_le(file, offsets.size(), 8);
+    write_le(file, offset, 8);
+    file.close();
+    if (!file) {
+        throw std::invalid_argument("Unable to write level pack.");
+    }
+}
+
+void write_level_pack(const std::string &path, const std::vector<CraftWorldGameState> &states) {
+    LevelPackWriter writer(path);
+    for (const auto &state : states) {
+        writer.add(state);
+    }
+    writer.finish();
+}
+
+LevelPack::LevelPack(const std::string &path) {
+#ifdef CRAFTWORLD_HAS_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);    // NOLINT(*-vararg)
+    if (fd < 0) {
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0) {
+        ::close(fd);
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    data_size = static_cast<std::size_t>(file_stat.st_size);
+    if (data_size > 0) {
+        void *mapped = ::mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::invalid_argument("Unable to map " + path);
+        }
+        data = static_cast<const uint8_t *>(mapped);
+    }
+    // Mapping stays valid after the descriptor is closed
+    ::close(fd);
+#else
+    const auto contents = read_file(path);
+    buffer.assign(contents.begin(), contents.end());
+    data = buffer.data();
+    data_size = buffer.size();
+#endif
+
+    const bool valid_header = data_size >= kLevelPackHeaderSize &&
+                              std::equal(kLevelPackMagic.begin(), kLevelPackMagic.end(), data) &&
+                              read_le(data + 4, 4) == kLevelPackVersion;
+    if (valid_header) {
+        num_levels = static_cast<std::size_t>(read_le(data + 8, 8));
+        index_offset = static_cast<std::size_t>(read_le(data + 16, 8));
+    }
+    if (!valid_header || index_offset < kLevelPackHeaderSize || index_offset > data_size ||
+        num_levels > (data_size - index_offset) / 8) {
+        Unmap();
+        throw std::invalid_argument(path + " is not a level pack.");
+    }
+}
+
+LevelPack::~LevelPack() {
+    Unmap();
+}
+
+void LevelPack::Unmap() noexcept {
+#ifdef CRAFTWORLD_HAS_MMAP
+    if (data != nullptr) {
+        ::munmap(const_cast<uint8_t *>(data), data_size);    // NOLINT(*-const-cast)
+    }
+#endif
+    data = nullptr;
+}
+
+auto LevelPack::size() const noexcept -> std::size_t {
+    return num_levels;
+}
+
+auto LevelPack::get(std::size_t level_idx) const -> CraftWorldGameState {
+    if (level_idx >= num_levels) {
+        throw std::invalid_argument("Level index out of range.");
+    }
+    const auto record_offset = static_cast<std::size_t>(read_le(data + index_offset + (level_idx * 8), 8));
+    // Compared without adding to record_offset, which could overflow, as index_offset >= kLevelPackHeaderSize
+    if (record_offset < kLevelPackHeaderSize || record_offset > index_offset - kLevelRecordHeaderSize) {
+        throw std::invalid_argument("Corrupt level pack record.");
+    }
+    const uint8_t *record = data + record_offset;
+    const int rows = record[0];
+    const int cols = record[1];
+    const auto num_cells = static_cast<std::size_t>(rows * cols);
+    if (num_cells > index_offset - kLevelRecordHeaderSize - record_offset) {
+        throw std::invalid_argument("Corrupt level pack record.");
+    }
+    return {rows, cols, static_cast<Element>(record[2]), {record + kLevelRecordHeaderSize, num_cells}};
+}
+
+}    // namespace craftworld
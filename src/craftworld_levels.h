@@ -0,0 +1,115 @@
+#ifndef CRAFTWORLD_LEVELS_H_
+#define CRAFTWORLD_LEVELS_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+/**
+ * Load every level of a problems file, one board string per line, parsing the lines in parallel.
+ * Blank lines are skipped.
+ * @param path Path to the problems file
+ * @param num_threads Number of threads, including the calling thread
+ * @return State for each non-blank line, in file order
+ * @throws std::invalid_argument if the file cannot be read, or with the line number of the first invalid board
+ */
+[[nodiscard]] auto load_levels(const std::string &path, int num_threads = 1) -> std::vector<CraftWorldGameState>;
+
+// Binary level pack, every integer is little-endian:
+//   0: magic "CWLP"
+//   4: uint32 format version
+//   8: uint64 number of levels
+//  16: uint64 byte offset of the index
+//  24: level records, each uint8 rows, uint8 cols, uint8 goal, then rows * cols uint8 cells in row-major order
+//  index: uint64 byte offset of each level record
+// Only the board and goal are stored, so levels start with an empty inventory.
+constexpr uint32_t kLevelPackVersion = 1;
+
+// Writes levels to a pack one at a time, so large problem sets can be converted without holding every state
+class LevelPackWriter {
+public:
+    /**
+     * Create the pack file, overwriting any existing file.
+     * @param path Path of the pack to write
+     */
+    explicit LevelPackWriter(const std::string &path);
+    ~LevelPackWriter();
+
+    LevelPackWriter(const LevelPackWriter &) = delete;
+    LevelPackWriter(LevelPackWriter &&) = delete;
+    auto operator=(const LevelPackWriter &) -> LevelPackWriter & = delete;
+    auto operator=(LevelPackWriter &&) -> LevelPackWriter & = delete;
+
+    /**
+     * Append a level.
+     * @param state Level to append, which must have an empty inventory
+     */
+    void add(const CraftWorldGameState &state);
+
+    /**
+     * Write the index and header, after which no more levels can be added.
+     * Called by the destructor if not called before.
+     */
+    void finish();
+
+private:
+    std::ofstream file;
+    std::vector<uint64_t> offsets;
+    uint64_t offset = 0;
+    bool finished = false;
+};
+
+/**
+ * Write levels to a new pack.
+ * @param path Path of the pack to write
+ * @param states Levels to write, each with an empty inventory
+ */
+void write_level_pack(const std::string &path, const std::vector<CraftWorldGameState> &states);
+
+// Read-only view of a level pack, memory mapped so opening is instant and only the levels accessed are read
+class LevelPack {
+public:
+    /**
+     * Open a pack.
+     * @param path Path of the pack to open
+     * @throws std::invalid_argument if the file cannot be opened or is not a level pack
+     */
+    explicit LevelPack(const std::string &path);
+    ~LevelPack();
+
+    LevelPack(const LevelPack &) = delete;
+    LevelPack(LevelPack &&) = delete;
+    auto operator=(const LevelPack &) -> LevelPack & = delete;
+    auto operator=(LevelPack &&) -> LevelPack & = delete;
+
+    /**
+     * Get the number of levels in the pack.
+     * @return Count of levels
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /**
+     * Build the state of a level, reading only that level's record.
+     * @param level_idx Index of the level
+     * @return Game state
+     */
+    [[nodiscard]] auto get(std::size_t level_idx) const -> CraftWorldGameState;
+
+private:
+    void Unmap() noexcept;
+
+    const uint8_t *data = nullptr;
+    std::size_t data_size = 0;
+    std::size_t num_levels = 0;
+    std::size_t index_offset = 0;
+    std::vector<uint8_t> buffer;    // File contents where memory mapping is unavailable
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_LEVELS_H_
@@ -0,0 +1,133 @@
+#include "craftworld_renderer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "definitions.h"
+
+namespace craftworld {
+
+namespace {
+// Marks a frame tile as not yet drawn, never matches a real tile
+constexpr uint8_t kUndrawnTile = 0xFF;
+}    // namespace
+
+// Spite assets
+#include "assets_all.inc"
+
+namespace {
+auto tile_size_index(int tile_size) -> std::size_t {
+    const auto it = std::find(kTileSizes.begin(), kTileSizes.end(), tile_size);
+    if (it == kTileSizes.end()) {
+        throw std::invalid_argument("Unsupported tile size.");
+    }
+    return static_cast<std::size_t>(it - kTileSizes.begin());
+}
+
+// Downscale each full resolution sprite by averaging (rounded) each block of pixels
+auto make_atlas(const std::vector<uint8_t> &full_atlas, int tile_size) -> std::vector<uint8_t> {
+    const int scale = SPRITE_WIDTH / tile_size;
+    const int block_count = scale * scale;
+    const auto tile_len = static_cast<std::size_t>(tile_size * tile_size * SPRITE_CHANNELS);
+    std::vector<uint8_t> atlas(static_cast<std::size_t>(kBlankTile + 1) * tile_len, 0);
+    for (std::size_t tile = 0; tile <= kBlankTile; ++tile) {
+        const uint8_t *src = full_atlas.data() + (tile * SPRITE_DATA_LEN);
+        uint8_t *dst = atlas.data() + (tile * tile_len);
+        for (int r = 0; r < tile_size; ++r) {
+            for (int c = 0; c < tile_size; ++c) {
+                for (int ch = 0; ch < SPRITE_CHANNELS; ++ch) {
+                    int sum = 0;
+                    for (int dr = 0; dr < scale; ++dr) {
+                        const uint8_t *src_row = src + ((r * scale + dr) * SPRITE_DATA_LEN_PER_ROW);
+                        for (int dc = 0; dc < scale; ++dc) {
+                            sum += src_row[((c * scale + dc) * SPRITE_CHANNELS) + ch];
+                        }
+                    }
+                    dst[(r * tile_size + c) * SPRITE_CHANNELS + ch] =
+                        static_cast<uint8_t>((sum + block_count / 2) / block_count);
+                }
+            }
+        }
+    }
+    return atlas;
+}
+}    // namespace
+
+auto sprite_atlas(int tile_size) -> std::span<const uint8_t> {
+    static const auto atlases = []() {
+        std::array<std::vector<uint8_t>, kTileSizes.size()> data;
+        auto &full_atlas = data[tile_size_index(SPRITE_WIDTH)];
+        full_atlas.resize(static_cast<std::size_t>(kBlankTile + 1) * SPRITE_DATA_LEN, 0);
+        for (int el = 0; el < kNumElements; ++el) {
+            const auto &sprite = img_asset_map.at(static_cast<Element>(el));
+            std::copy(sprite.begin(), sprite.end(),
+                      full_atlas.begin() + static_cast<std::ptrdiff_t>(el * SPRITE_DATA_LEN));
+        }
+        for (const auto &size : kTileSizes) {
+            if (size != SPRITE_WIDTH) {
+                data[tile_size_index(size)] = make_atlas(full_atlas, size);
+            }
+        }
+        return data;
+    }();
+    return atlases[tile_size_index(tile_size)];
+}
+
+void draw_tile(std::span<uint8_t> img, int cols_img, int h, int w, uint8_t tile, int tile_size) {
+    const auto atlas = sprite_atlas(tile_size);
+    const auto row_len = static_cast<std::size_t>(tile_size * SPRITE_CHANNELS);
+    const uint8_t *sprite = atlas.data() + (static_cast<std::size_t>(tile) * row_len * tile_size);
+    const auto img_row_len = static_cast<std::size_t>(cols_img) * row_len;
+    uint8_t *top_left = img.data() + (static_cast<std::size_t>(h * tile_size) * img_row_len) +
+                        (static_cast<std::size_t>(w) * row_len);
+    for (std::size_t r = 0; r < static_cast<std::size_t>(tile_size); ++r) {
+        std::memcpy(top_left + (r * img_row_len), sprite + (r * row_len), row_len);
+    }
+}
+
+CraftWorldRenderer::CraftWorldRenderer(int tile_size) : sprite_size(tile_size) {
+    if (!CraftWorldGameState::is_valid_tile_size(tile_size)) {
+        throw std::invalid_argument("Unsupported tile size.");
+    }
+}
+
+auto CraftWorldRenderer::render(const CraftWorldGameState &state) -> std::span<const uint8_t> {
+    const auto state_shape = state.image_shape(sprite_size);
+    const auto [num_channels, rows_img, cols_tiles] = state.observation_shape();
+    const auto num_tiles = static_cast<std::size_t>(rows_img * cols_tiles);
+    if (state_shape != shape || frame.empty()) {
+        // New dimensions, every tile needs drawing
+        shape = state_shape;
+        cols_img = cols_tiles;
+        frame.assign(num_tiles * static_cast<std::size_t>(sprite_size * sprite_size * SPRITE_CHANNELS), 0);
+        tiles.assign(num_tiles, kUndrawnTile);
+        next_tiles.assign(num_tiles, kBlankTile);
+    }
+
+    // Redraw only tiles which differ from the current frame
+    state.write_tiles(next_tiles);
+    for (std::size_t i = 0; i < num_tiles; ++i) {
+        if (next_tiles[i] != tiles[i]) {
+            const auto tile_idx = static_cast<int>(i);
+            draw_tile(frame, cols_img, tile_idx / cols_img, tile_idx % cols_img, next_tiles[i], sprite_size);
+        }
+    }
+    tiles.swap(next_tiles);
+    return frame;
+}
+
+auto CraftWorldRenderer::image_shape() const noexcept -> std::array<int, 3> {
+    return shape;
+}
+
+auto CraftWorldRenderer::tile_size() const noexcept -> int {
+    return sprite_size;
+}
+
+void CraftWorldRenderer::reset() noexcept {
+    frame.clear();
+}
+
+}    // namespace craftworld
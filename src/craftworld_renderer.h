@@ -0,0 +1,78 @@
+#ifndef CRAFTWORLD_RENDERER_H_
+#define CRAFTWORLD_RENDERER_H_
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+/**
+ * Get the contiguous sprite atlas for a tile size, holding tile_size * tile_size * SPRITE_CHANNELS bytes (HWC)
+ * per tile. Tile i is the sprite for element i, and tile kBlankTile is black.
+ * Smaller tile sizes are area averaged from the full resolution sprites, once on first use.
+ * @param tile_size Tile width/height in pixels, one of kTileSizes
+ * @return atlas of (kBlankTile + 1) sprites
+ */
+[[nodiscard]] auto sprite_atlas(int tile_size = SPRITE_WIDTH) -> std::span<const uint8_t>;
+
+/**
+ * Copy a tile sprite into an image, one sprite row at a time.
+ * @param img Flat (HWC) image made of sprite tiles
+ * @param cols_img Number of tiles per image row
+ * @param h Tile row
+ * @param w Tile column
+ * @param tile Element or kBlankTile to draw
+ * @param tile_size Tile width/height in pixels, one of kTileSizes
+ */
+void draw_tile(std::span<uint8_t> img, int cols_img, int h, int w, uint8_t tile, int tile_size = SPRITE_WIDTH);
+
+// Renders states into a persistent frame, redrawing only the tiles which changed since the previous render
+class CraftWorldRenderer {
+public:
+    /**
+     * Create the renderer.
+     * @param tile_size Tile width/height in pixels, one of kTileSizes
+     */
+    explicit CraftWorldRenderer(int tile_size = SPRITE_WIDTH);
+
+    /**
+     * Render the state, producing the same pixels as CraftWorldGameState::to_image(tile_size).
+     * A state with different rows/cols from the previous render is drawn in full.
+     * @param state State to render
+     * @return flat (HWC) frame, overwritten by the next render
+     */
+    auto render(const CraftWorldGameState &state) -> std::span<const uint8_t>;
+
+    /**
+     * Get the shape the last rendered frame should be viewed as.
+     * @return array indicating image HWC
+     */
+    [[nodiscard]] auto image_shape() const noexcept -> std::array<int, 3>;
+
+    /**
+     * Forget the previous frame, so the next render draws every tile.
+     */
+    void reset() noexcept;
+
+    /**
+     * Get the tile size frames are rendered at.
+     * @return Tile width/height in pixels
+     */
+    [[nodiscard]] auto tile_size() const noexcept -> int;
+
+private:
+    int sprite_size;    // Tile width/height in pixels
+    std::array<int, 3> shape{};
+    int cols_img = 0;
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> tiles;         // Tiles drawn in the frame
+    std::vector<uint8_t> next_tiles;    // Tiles of the state being rendered
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_RENDERER_H_
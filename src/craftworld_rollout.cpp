@@ -0,0 +1,154 @@
+#include "craftworld_rollout.h"
+
+#include <bit>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+
+namespace craftworld {
+
+namespace {
+// Rollouts are short and of very uneven length, so a few are run per call to amortize stealing
+constexpr std::size_t kRolloutGrain = 4;
+
+// Seed of one rollout, mixed so neighbouring rollouts get unrelated streams
+auto rollout_seed(uint64_t seed, std::size_t rollout_idx) noexcept -> uint64_t {
+    // NOLINTBEGIN(*-magic-numbers)
+    uint64_t z = seed + (static_cast<uint64_t>(rollout_idx) + 1) * 0x9E3779B97F4A7C15;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+    // NOLINTEND(*-magic-numbers)
+}
+
+auto uniform_action(std::mt19937_64 &rng) -> Action {
+    return static_cast<Action>(rng() % kNumActions);
+}
+
+auto masked_uniform_action(const CraftWorldGameState &state, std::mt19937_64 &rng) -> Action {
+    const uint32_t mask = state.effective_action_mask();
+    if (mask == 0) {
+        return uniform_action(rng);
+    }
+    // Index of the k-th set bit
+    auto k = static_cast<int>(rng() % static_cast<uint64_t>(std::popcount(mask)));
+    for (int action = 0; action < kNumActions; ++action) {
+        if ((mask & (1U << static_cast<uint32_t>(action))) != 0 && k-- == 0) {
+            return static_cast<Action>(action);
+        }
+    }
+    return uniform_action(rng);
+}
+
+// Totals of the rollouts run by one call, merged into the shared totals once per call
+struct RolloutTotals {
+    int64_t num_solved = 0;
+    int64_t total_steps = 0;
+    int64_t solved_steps = 0;
+    std::array<int64_t, kNumRewardBits> reward_bit_counts{};
+
+    void merge(const RolloutTotals &other) noexcept {
+        num_solved += other.num_solved;
+        total_steps += other.total_steps;
+        solved_steps += other.solved_steps;
+        for (std::size_t bit = 0; bit < reward_bit_counts.size(); ++bit) {
+            reward_bit_counts[bit] += other.reward_bit_counts[bit];
+        }
+    }
+};
+}    // namespace
+
+RolloutEngine::RolloutEngine(int num_threads) : pool(num_threads) {}
+
+auto RolloutEngine::run(const CraftWorldGameState &root, const RolloutOptions &options) -> RolloutStats {
+    if (options.num_rollouts < 0) {
+        throw std::invalid_argument("Number of rollouts must be non-negative.");
+    }
+    if (options.max_depth < 0) {
+        throw std::invalid_argument("Rollout depth must be non-negative.");
+    }
+    if (options.policy == RolloutPolicy::kCallback && !options.callback) {
+        throw std::invalid_argument("Callback policy requires a callback.");
+    }
+
+    std::mutex totals_mutex;
+    RolloutTotals totals;
+    std::exception_ptr error;
+    pool.parallel_for_stealing(
+        static_cast<std::size_t>(options.num_rollouts),
+        [&](std::size_t begin, std::size_t end) {
+            RolloutTotals local;
+            std::mt19937_64 rng;
+            try {
+                for (std::size_t i = begin; i < end; ++i) {
+                    rng.seed(rollout_seed(options.seed, i));
+                    CraftWorldGameState state = root;
+                    uint64_t reward_bits = 0;
+                    int depth = 0;
+                    for (; depth < options.max_depth && !state.is_solution(); ++depth) {
+                        Action action{};
+                        switch (options.policy) {
+                            case RolloutPolicy::kUniform:
+                                action = uniform_action(rng);
+                                break;
+                            case RolloutPolicy::kMaskedUniform:
+                                action = masked_uniform_action(state, rng);
+                                break;
+                            case RolloutPolicy::kCallback:
+                                action = options.callback(state, rng);
+                                if (!CraftWorldGameState::is_valid_action(action)) {
+                                    throw std::invalid_argument("Rollout callback returned an invalid action.");
+                                }
+                                break;
+                        }
+                        state.apply_action(action);
+                        reward_bits |= state.get_reward_signal();
+                    }
+                    local.total_steps += depth;
+                    if (state.is_solution()) {
+                        ++local.num_solved;
+                        local.solved_steps += depth;
+                    }
+                    for (; reward_bits != 0; reward_bits &= reward_bits - 1) {
+                        ++local.reward_bit_counts[static_cast<std::size_t>(std::countr_zero(reward_bits))];
+                    }
+                }
+            } catch (...) {
+                // Pool jobs must not throw, the first error is rethrown once every thread is done
+                const std::lock_guard<std::mutex> lock(totals_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                return;
+            }
+            const std::lock_guard<std::mutex> lock(totals_mutex);
+            totals.merge(local);
+        },
+        kRolloutGrain);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    RolloutStats stats;
+    stats.num_rollouts = options.num_rollouts;
+    stats.num_solved = totals.num_solved;
+    stats.total_steps = totals.total_steps;
+    stats.reward_bit_counts = totals.reward_bit_counts;
+    if (stats.num_rollouts > 0) {
+        const auto num_rollouts = static_cast<double>(stats.num_rollouts);
+        stats.solved_fraction = static_cast<double>(stats.num_solved) / num_rollouts;
+        for (std::size_t bit = 0; bit < stats.reward_bit_counts.size(); ++bit) {
+            stats.reward_bit_frequencies[bit] = static_cast<double>(stats.reward_bit_counts[bit]) / num_rollouts;
+        }
+    }
+    if (stats.num_solved > 0) {
+        stats.mean_steps_to_solve = static_cast<double>(totals.solved_steps) / static_cast<double>(stats.num_solved);
+    }
+    return stats;
+}
+
+auto RolloutEngine::num_threads() const noexcept -> int {
+    return pool.num_threads();
+}
+
+}    // namespace craftworld
@@ -0,0 +1,76 @@
+#ifndef CRAFTWORLD_ROLLOUT_H_
+#define CRAFTWORLD_ROLLOUT_H_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <random>
+
+#include "craftworld_base.h"
+#include "thread_pool.h"
+
+namespace craftworld {
+
+enum class RolloutPolicy {
+    kUniform = 0,          // Every action equally likely
+    kMaskedUniform = 1,    // Uniform over effective_action_mask(), or every action if the mask is empty
+    kCallback = 2,         // RolloutOptions::callback
+};
+
+// Chooses the next action of a rollout. Called from every thread of the engine, so it must be thread safe.
+using RolloutCallback = std::function<Action(const CraftWorldGameState &state, std::mt19937_64 &rng)>;
+
+struct RolloutOptions {
+    int num_rollouts = 1;
+    int max_depth = 100;    // Actions per rollout, unless the goal is reached first
+    RolloutPolicy policy = RolloutPolicy::kUniform;
+    RolloutCallback callback{};    // Used with RolloutPolicy::kCallback
+    uint64_t seed = 0;
+};
+
+constexpr int kNumRewardBits = 64;
+
+struct RolloutStats {
+    int64_t num_rollouts = 0;
+    int64_t num_solved = 0;                  // Rollouts which reached is_solution()
+    int64_t total_steps = 0;                 // Actions applied across every rollout
+    double solved_fraction = 0;              // num_solved / num_rollouts
+    double mean_steps_to_solve = 0;          // Mean actions taken by solved rollouts, 0 if none solved
+    std::array<int64_t, kNumRewardBits> reward_bit_counts{};    // Rollouts in which each reward signal bit was set
+    std::array<double, kNumRewardBits> reward_bit_frequencies{};    // reward_bit_counts / num_rollouts
+};
+
+// Runs many rollouts from one root state across a work-stealing thread pool, for Monte Carlo evaluation.
+// Rollout i draws from an RNG seeded from (seed, i), so the statistics do not depend on the number of threads
+// or on which thread ran which rollout.
+class RolloutEngine {
+public:
+    /**
+     * Create the engine.
+     * @param num_threads Number of threads running rollouts, including the calling thread
+     */
+    explicit RolloutEngine(int num_threads = 1);
+
+    /**
+     * Run the rollouts, each from a copy of the root state, and aggregate their statistics.
+     * @param root State every rollout starts from
+     * @param options Rollout count, depth, policy and seed
+     * @return Aggregated statistics
+     * @throws std::invalid_argument if the options are invalid or the callback returns an invalid action,
+     *   and rethrows the first exception thrown by the callback
+     */
+    [[nodiscard]] auto run(const CraftWorldGameState &root, const RolloutOptions &options) -> RolloutStats;
+
+    /**
+     * Get the number of threads running rollouts, including the calling thread.
+     * @return Thread count
+     */
+    [[nodiscard]] auto num_threads() const noexcept -> int;
+
+private:
+    ThreadPool pool;
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_ROLLOUT_H_
@@ -0,0 +1,500 @@
+#include "craftworld_solver.h"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "craftworld_arena.h"
+#include "definitions.h"
+#include "thread_pool.h"
+
+namespace craftworld {
+
+namespace {
+
+// States are kept in a StateArena, so each node costs a compact slot rather than a full state
+struct Node {
+    StateHandle state;
+    int64_t parent;
+    Action action;
+    int g;
+    bool closed = false;
+};
+
+// Closed/open set keyed on the state hash, with collisions resolved by comparing states
+class TranspositionTable {
+public:
+    // Index of the node holding an equal state, or -1 if not seen
+    [[nodiscard]] auto find(const std::vector<Node> &nodes, const StateArena &arena,
+                            const CraftWorldGameState &state) const -> int64_t {
+        const auto [begin, end] = table.equal_range(state.get_hash());
+        for (auto it = begin; it != end; ++it) {
+            if (arena.equals(nodes[it->second].state, state)) {
+                return static_cast<int64_t>(it->second);
+            }
+        }
+        return -1;
+    }
+
+    void insert(const CraftWorldGameState &state, std::size_t node_idx) {
+        table.emplace(state.get_hash(), node_idx);
+    }
+
+private:
+    std::unordered_multimap<uint64_t, std::size_t> table;
+};
+
+// Cells which block the agent until removed with a tool, which is used up
+struct Barrier {
+    Element cell;
+    Element tool;
+};
+constexpr std::array<Barrier, 2> kBarriers{{
+    {Element::kStone, Element::kIronPick},
+    {Element::kWater, Element::kBridge},
+}};
+
+// Lower bound on the steps to the goal from the crafting still to do. Walking the recipes down from the goal, every
+// unit of an element not covered by the inventory costs one use action, to collect it or craft it from its inputs.
+// Tools count as inputs while needed: a bronze pick to collect iron, and an iron pick or a bridge while the root's
+// stone or water still cuts the agent off from every source of an element.
+// The agent must also stand beside a source of each such element (the element itself if collected, its workshop if
+// crafted), and only after the last of those beside a source of the goal. Moves are counted on a relaxed board
+// where every cell but walls and workshops is walkable, and sources are taken from the root, which covers every
+// later state as cells are only ever removed. So the bound is
+//   (uses needed) + max(moves to the goal, max over needed elements of moves to the goal through that element)
+// It is consistent for unit costs: a move changes each term by at most 1, a use which removes an element from the
+// needed ones is made beside its source, where its term is no larger than the term of the goal, and a tool stops
+// being needed only when used, after which it is no longer held.
+class CraftingLowerBound {
+public:
+    // Bound of a state from which the goal can never be reached
+    static constexpr int kDeadEnd = std::numeric_limits<int>::max();
+
+    explicit CraftingLowerBound(const CraftWorldGameState &root)
+        : board(root.pack().grid), rows(root.get_board_shape()[0]), cols(root.get_board_shape()[1]) {
+        for (const auto &recipe : kCraftOrder) {
+            const auto &def = kRecipes[static_cast<std::size_t>(recipe)];
+            recipes[static_cast<std::size_t>(def.output)] = &def;
+        }
+        for (std::size_t b = 0; b < kBarriers.size(); ++b) {
+            FindBarrier(b, root.get_agent_index());
+        }
+        AddElement(root.get_goal());
+        // Elements were added after their inputs, so reversing puts every element before its inputs
+        std::reverse(order.begin(), order.end());
+        auto &goal_moves = via_moves[static_cast<std::size_t>(root.get_goal())];
+        goal_moves = Moves(Source(root.get_goal()), std::vector<int>(board.size(), 0));
+        for (const auto &el : order) {
+            if (el != root.get_goal()) {
+                via_moves[static_cast<std::size_t>(el)] = Moves(Source(el), goal_moves);
+            }
+        }
+    }
+
+    [[nodiscard]] auto operator()(const CraftWorldGameState &state) const -> int {
+        if (state.is_solution()) {
+            return 0;
+        }
+        const auto agent_idx = static_cast<std::size_t>(state.get_agent_index());
+        std::array<int, kNumElements> demand{};
+        demand[static_cast<std::size_t>(state.get_goal())] = 1;
+        int uses = 0;
+        int moves = 0;
+        for (const auto &el : order) {
+            const auto el_idx = static_cast<std::size_t>(el);
+            const int deficit = demand[el_idx] - state.check_inventory(el);
+            if (deficit <= 0) {
+                continue;
+            }
+            const int el_moves = via_moves[el_idx][agent_idx];
+            if (el_moves == kDeadEnd) {
+                return kDeadEnd;
+            }
+            uses += deficit;
+            moves = std::max(moves, el_moves);
+            if (const auto *recipe = recipes[el_idx]; recipe != nullptr) {
+                for (int i = 0; i < recipe->num_inputs; ++i) {
+                    const auto &input = recipe->inputs[static_cast<std::size_t>(i)];
+                    demand[static_cast<std::size_t>(input.element)] += deficit * input.count;
+                }
+            }
+            // Tools are kept or used up once, so one is enough however many units are needed
+            for (const auto &need : tools[el_idx]) {
+                if (need.barrier < 0 || IsBarrierIntact(state, static_cast<std::size_t>(need.barrier))) {
+                    auto &tool_demand = demand[static_cast<std::size_t>(need.tool)];
+                    tool_demand = std::max(tool_demand, 1);
+                }
+            }
+        }
+        return uses + moves;
+    }
+
+private:
+    struct ToolNeed {
+        Element tool;
+        int barrier;    // Index into kBarriers, or -1 if always needed
+    };
+
+    // Add an element after its inputs and tools, once each. A tool whose own inputs need the element is left out,
+    // which only loosens the bound.
+    void AddElement(Element el) {
+        const auto el_idx = static_cast<std::size_t>(el);
+        visit[el_idx] = kVisiting;
+        if (const auto *recipe = recipes[el_idx]; recipe != nullptr) {
+            for (int i = 0; i < recipe->num_inputs; ++i) {
+                const auto input = recipe->inputs[static_cast<std::size_t>(i)].element;
+                if (visit[static_cast<std::size_t>(input)] == kUnvisited) {
+                    AddElement(input);
+                }
+            }
+        }
+        std::vector<ToolNeed> needs;
+        // Iron is only collected while holding a bronze pick
+        if (el == Element::kIron) {
+            needs.push_back({Element::kBronzePick, -1});
+        }
+        for (std::size_t b = 0; b < kBarriers.size(); ++b) {
+            if (IsCutOff(b, el)) {
+                needs.push_back({kBarriers[b].tool, static_cast<int>(b)});
+            }
+        }
+        for (const auto &need : needs) {
+            const auto tool_idx = static_cast<std::size_t>(need.tool);
+            if (visit[tool_idx] == kUnvisited) {
+                AddElement(need.tool);
+            }
+            if (visit[tool_idx] == kVisited) {
+                tools[el_idx].push_back(need);
+            }
+        }
+        visit[el_idx] = kVisited;
+        order.push_back(el);
+    }
+
+    // Element whose cells an element is collected or crafted beside, if any
+    [[nodiscard]] auto Source(Element el) const noexcept -> std::optional<Element> {
+        if (const auto *recipe = recipes[static_cast<std::size_t>(el)]; recipe != nullptr) {
+            return recipe->location;
+        }
+        if (static_cast<int>(el) >= kRecipeStart) {
+            return std::nullopt;
+        }
+        return el;
+    }
+
+    [[nodiscard]] auto IsWalkable(int idx) const noexcept -> bool {
+        const auto el = static_cast<Element>(board[static_cast<std::size_t>(idx)]);
+        return el != Element::kWall && !(el >= Element::kWorkshop1 && el <= Element::kFurnace);
+    }
+
+    template <typename Func>
+    void ForEachNeighbour(int idx, Func &&func) const {
+        const int r = idx / cols;
+        const int c = idx % cols;
+        if (r > 0) {
+            func(idx - cols);
+        }
+        if (r < rows - 1) {
+            func(idx + cols);
+        }
+        if (c > 0) {
+            func(idx - 1);
+        }
+        if (c < cols - 1) {
+            func(idx + 1);
+        }
+    }
+
+    // Cells the agent can reach from the root without removing a barrier cell, and the barrier cells around them
+    void FindBarrier(std::size_t barrier, int agent_idx) {
+        const auto barrier_cell = static_cast<int>(kBarriers[barrier].cell);
+        auto &region = regions[barrier];
+        region.assign(board.size(), false);
+        region[static_cast<std::size_t>(agent_idx)] = true;
+        std::vector<int> stack{agent_idx};
+        while (!stack.empty()) {
+            const int idx = stack.back();
+            stack.pop_back();
+            ForEachNeighbour(idx, [&](int neighbour) {
+                const auto n_idx = static_cast<std::size_t>(neighbour);
+                if (board[n_idx] == barrier_cell) {
+                    frontiers[barrier].push_back(neighbour);
+                } else if (!region[n_idx] && IsWalkable(neighbour)) {
+                    region[n_idx] = true;
+                    stack.push_back(neighbour);
+                }
+            });
+        }
+        std::sort(frontiers[barrier].begin(), frontiers[barrier].end());
+        frontiers[barrier].erase(std::unique(frontiers[barrier].begin(), frontiers[barrier].end()),
+                                 frontiers[barrier].end());
+    }
+
+    // Whether no source of the element can be stood beside without removing a barrier cell
+    [[nodiscard]] auto IsCutOff(std::size_t barrier, Element el) const -> bool {
+        const auto source = Source(el);
+        if (!source || frontiers[barrier].empty()) {
+            return false;
+        }
+        for (int idx = 0; idx < static_cast<int>(board.size()); ++idx) {
+            if (static_cast<Element>(board[static_cast<std::size_t>(idx)]) != *source) {
+                continue;
+            }
+            bool reached = false;
+            ForEachNeighbour(idx, [&](int neighbour) { reached = reached || regions[barrier][neighbour]; });
+            if (reached) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Barrier cells are only removed by their tool, so while every one around the region remains the agent is in it
+    [[nodiscard]] auto IsBarrierIntact(const CraftWorldGameState &state, std::size_t barrier) const -> bool {
+        return std::all_of(frontiers[barrier].begin(), frontiers[barrier].end(),
+                           [&](int idx) { return state.get_element(idx) == kBarriers[barrier].cell; });
+    }
+
+    // Fewest relaxed moves from each cell to a walkable cell beside a source, plus the cost of continuing from there
+    [[nodiscard]] auto Moves(std::optional<Element> source, const std::vector<int> &then) const -> std::vector<int> {
+        std::vector<int> moves(board.size(), kDeadEnd);
+        if (!source) {
+            return moves;
+        }
+        using Entry = std::pair<int, int>;    // Moves, cell
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> open;
+        for (int idx = 0; idx < static_cast<int>(board.size()); ++idx) {
+            if (static_cast<Element>(board[static_cast<std::size_t>(idx)]) != *source) {
+                continue;
+            }
+            ForEachNeighbour(idx, [&](int neighbour) {
+                const int cost = then[static_cast<std::size_t>(neighbour)];
+                if (IsWalkable(neighbour) && cost < moves[static_cast<std::size_t>(neighbour)]) {
+                    moves[static_cast<std::size_t>(neighbour)] = cost;
+                    open.emplace(cost, neighbour);
+                }
+            });
+        }
+        while (!open.empty()) {
+            const auto [cost, idx] = open.top();
+            open.pop();
+            if (cost != moves[static_cast<std::size_t>(idx)]) {
+                continue;
+            }
+            ForEachNeighbour(idx, [&](int neighbour) {
+                if (IsWalkable(neighbour) && cost + 1 < moves[static_cast<std::size_t>(neighbour)]) {
+                    moves[static_cast<std::size_t>(neighbour)] = cost + 1;
+                    open.emplace(cost + 1, neighbour);
+                }
+            });
+        }
+        return moves;
+    }
+
+    static constexpr uint8_t kUnvisited = 0;
+    static constexpr uint8_t kVisiting = 1;
+    static constexpr uint8_t kVisited = 2;
+
+    std::vector<int> board;    // Element of each cell of the root
+    int rows;
+    int cols;
+    std::vector<Element> order;    // Each element before its inputs and tools
+    std::array<uint8_t, kNumElements> visit{};
+    std::array<const RecipeDef *, kNumElements> recipes{};        // Craftable recipe of each element
+    std::array<std::vector<ToolNeed>, kNumElements> tools;       // Tools needed to get each element
+    std::array<std::vector<int>, kNumElements> via_moves;        // Per cell, moves to the goal through the element
+    std::array<std::vector<bool>, kBarriers.size()> regions;    // Per cell, reachable without removing the barrier
+    std::array<std::vector<int>, kBarriers.size()> frontiers;   // Barrier cells around each region
+};
+
+auto extract_plan(const std::vector<Node> &nodes, std::size_t node_idx) -> std::vector<Action> {
+    std::vector<Action> actions;
+    for (auto idx = static_cast<int64_t>(node_idx); nodes[static_cast<std::size_t>(idx)].parent >= 0;
+         idx = nodes[static_cast<std::size_t>(idx)].parent) {
+        actions.push_back(nodes[static_cast<std::size_t>(idx)].action);
+    }
+    std::reverse(actions.begin(), actions.end());
+    return actions;
+}
+
+auto solve_bfs(const CraftWorldGameState &root, const SolverOptions &options) -> SolverResult {
+    SolverResult result;
+    std::vector<Node> nodes;
+    StateArena arena(root);
+    TranspositionTable table;
+    nodes.push_back({.state = arena.add(root), .parent = -1, .action = Action::kUse, .g = 0});
+    table.insert(root, 0);
+    if (root.is_solution()) {
+        result.status = SolverStatus::kSolved;
+        return result;
+    }
+
+    // Nodes are appended in generation order, so the node list doubles as the FIFO queue
+    for (std::size_t head = 0; head < nodes.size(); ++head) {
+        if (options.max_expansions > 0 && result.expanded >= options.max_expansions) {
+            result.status = SolverStatus::kLimitReached;
+            result.generated = static_cast<int64_t>(nodes.size());
+            return result;
+        }
+        ++result.expanded;
+        // Children are made by applying then undoing on one copy, so duplicates are never stored
+        CraftWorldGameState state = root;
+        arena.load(nodes[head].state, state);
+        const int g = nodes[head].g + 1;
+        // No-op actions only lead back to this node, so they are skipped before applying
+        const auto action_mask = state.effective_action_mask();
+        for (const auto &action : kAllActions) {
+            if ((action_mask & (1U << static_cast<uint32_t>(action))) == 0) {
+                continue;
+            }
+            const auto undo_record = state.apply_action_with_undo(action);
+            if (table.find(nodes, arena, state) < 0) {
+                nodes.push_back(
+                    {.state = arena.add(state), .parent = static_cast<int64_t>(head), .action = action, .g = g});
+                table.insert(state, nodes.size() - 1);
+                // Goal test on generation is still optimal for BFS
+                if (state.is_solution()) {
+                    result.status = SolverStatus::kSolved;
+                    result.actions = extract_plan(nodes, nodes.size() - 1);
+                    result.generated = static_cast<int64_t>(nodes.size());
+                    return result;
+                }
+            }
+            state.undo(undo_record);
+        }
+    }
+    result.status = SolverStatus::kUnsolvable;
+    result.generated = static_cast<int64_t>(nodes.size());
+    return result;
+}
+
+auto solve_astar(const CraftWorldGameState &root, const SolverOptions &options) -> SolverResult {
+    struct QueueEntry {
+        int f;
+        int g;
+        std::size_t node_idx;
+        // Lowest f first, ties broken towards deeper nodes
+        auto operator<(const QueueEntry &other) const noexcept -> bool {
+            return f != other.f ? f > other.f : g < other.g;
+        }
+    };
+
+    SolverResult result;
+    const CraftingLowerBound heuristic(root);
+    const int root_h = heuristic(root);
+    if (root_h == CraftingLowerBound::kDeadEnd) {
+        result.status = SolverStatus::kUnsolvable;
+        return result;
+    }
+
+    std::vector<Node> nodes;
+    StateArena arena(root);
+    TranspositionTable table;
+    std::priority_queue<QueueEntry> open;
+    nodes.push_back({.state = arena.add(root), .parent = -1, .action = Action::kUse, .g = 0});
+    table.insert(root, 0);
+    open.push({.f = root_h, .g = 0, .node_idx = 0});
+
+    CraftWorldGameState state = root;
+    while (!open.empty()) {
+        const auto entry = open.top();
+        open.pop();
+        // Stale entry from before a shorter path was found
+        if (nodes[entry.node_idx].closed || nodes[entry.node_idx].g != entry.g) {
+            continue;
+        }
+        arena.load(nodes[entry.node_idx].state, state);
+        if (state.is_solution()) {
+            result.status = SolverStatus::kSolved;
+            result.actions = extract_plan(nodes, entry.node_idx);
+            result.generated = static_cast<int64_t>(nodes.size());
+            return result;
+        }
+        if (options.max_expansions > 0 && result.expanded >= options.max_expansions) {
+            result.status = SolverStatus::kLimitReached;
+            result.generated = static_cast<int64_t>(nodes.size());
+            return result;
+        }
+        ++result.expanded;
+        nodes[entry.node_idx].closed = true;
+
+        const int g = entry.g + 1;
+        const auto action_mask = state.effective_action_mask();
+        for (const auto &action : kAllActions) {
+            if ((action_mask & (1U << static_cast<uint32_t>(action))) == 0) {
+                continue;
+            }
+            const auto undo_record = state.apply_action_with_undo(action);
+            const int64_t found_idx = table.find(nodes, arena, state);
+            // Most children are duplicates, so the bound is only computed for new states and shorter paths
+            if (found_idx < 0) {
+                const int h = heuristic(state);
+                // States which can no longer reach the goal are stored closed, so they are never expanded
+                nodes.push_back({.state = arena.add(state),
+                                 .parent = static_cast<int64_t>(entry.node_idx),
+                                 .action = action,
+                                 .g = g,
+                                 .closed = h == CraftingLowerBound::kDeadEnd});
+                table.insert(state, nodes.size() - 1);
+                if (h != CraftingLowerBound::kDeadEnd) {
+                    open.push({.f = g + h, .g = g, .node_idx = nodes.size() - 1});
+                }
+            } else if (auto &found = nodes[static_cast<std::size_t>(found_idx)]; !found.closed && g < found.g) {
+                // Shorter path to an open state
+                found.parent = static_cast<int64_t>(entry.node_idx);
+                found.action = action;
+                found.g = g;
+                open.push({.f = g + heuristic(state), .g = g, .node_idx = static_cast<std::size_t>(found_idx)});
+            }
+            state.undo(undo_record);
+        }
+    }
+    result.status = SolverStatus::kUnsolvable;
+    result.generated = static_cast<int64_t>(nodes.size());
+    return result;
+}
+
+}    // namespace
+
+auto solve(const CraftWorldGameState &state, const SolverOptions &options) -> SolverResult {
+    switch (options.algorithm) {
+        case SearchAlgorithm::kBFS:
+            return solve_bfs(state, options);
+        case SearchAlgorithm::kAStar:
+            return solve_astar(state, options);
+    }
+    throw std::invalid_argument("Unknown search algorithm.");
+}
+
+auto solve_all(const std::vector<CraftWorldGameState> &states, const SolverOptions &options, int num_threads)
+    -> std::vector<SolverResult> {
+    std::vector<SolverResult> results(states.size());
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    ThreadPool pool(num_threads);
+    pool.parallel_for(states.size(), [&](std::size_t begin, std::size_t end) {
+        try {
+            for (std::size_t i = begin; i < end; ++i) {
+                results[i] = solve(states[i], options);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            error = std::current_exception();
+        }
+    });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+}    // namespace craftworld
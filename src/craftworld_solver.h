@@ -0,0 +1,62 @@
+#ifndef CRAFTWORLD_SOLVER_H_
+#define CRAFTWORLD_SOLVER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+enum class SearchAlgorithm {
+    kBFS = 0,
+    kAStar = 1,
+};
+
+enum class SolverStatus {
+    kSolved = 0,
+    kUnsolvable = 1,       // Every reachable state was expanded
+    kLimitReached = 2,    // Stopped at the expansion limit
+};
+
+struct SolverOptions {
+    SearchAlgorithm algorithm = SearchAlgorithm::kBFS;
+    int64_t max_expansions = 0;    // 0 for no limit
+};
+
+struct SolverResult {
+    SolverStatus status = SolverStatus::kUnsolvable;
+    std::vector<Action> actions;    // Optimal plan if solved
+    int64_t expanded = 0;           // Number of states expanded
+    int64_t generated = 0;          // Number of unique states generated
+};
+
+/**
+ * Find a shortest action sequence which reaches is_solution() from the given state.
+ * Duplicate states are detected through a transposition table keyed on get_hash(),
+ * with hash collisions resolved by operator==.
+ * A* uses a consistent lower bound from the crafting still to do: the collect and craft actions needed, including
+ * the tools needed to mine iron or get past the stone or water around a source, plus the moves to the sources.
+ * It expands fewer states than BFS, which pays off on long crafting chains (about 30% faster on
+ * test_100_hard); on short chains (test_100) the cost of the bound per state about cancels the saving.
+ * @param state State to search from
+ * @param options Search options
+ * @return Search result
+ * @throws std::invalid_argument if the search algorithm is unknown
+ */
+[[nodiscard]] auto solve(const CraftWorldGameState &state, const SolverOptions &options = {}) -> SolverResult;
+
+/**
+ * Solve each state independently, spread across a thread pool.
+ * @param states States to search from
+ * @param options Search options used for every state
+ * @param num_threads Number of threads, including the calling thread
+ * @return Search result for each state, in order
+ * @throws std::invalid_argument if the search algorithm is unknown, or any error of a solve, once every thread is done
+ */
+[[nodiscard]] auto solve_all(const std::vector<CraftWorldGameState> &states, const SolverOptions &options = {},
+                             int num_threads = 1) -> std::vector<SolverResult>;
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_SOLVER_H_
@@ -0,0 +1,289 @@
+#include "craftworld_trajectory.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "craftworld_renderer.h"
+
+namespace craftworld {
+
+namespace {
+constexpr std::array<char, 4> kTrajectoryMagic{'C', 'W', 'T', 'R'};
+constexpr std::size_t kTrajectoryHeaderSize = 12;
+constexpr int kActionBits = 3;
+constexpr uint32_t kActionMask = (1U << kActionBits) - 1;
+static_assert(kNumActions <= (1 << kActionBits));
+
+void write_le(std::ofstream &file, uint64_t value, int num_bytes) {
+    std::array<char, sizeof(uint64_t)> bytes{};
+    for (int i = 0; i < num_bytes; ++i) {
+        bytes[static_cast<std::size_t>(i)] = static_cast<char>((value >> (8 * i)) & 0xFF);    // NOLINT(*-magic-numbers)
+    }
+    file.write(bytes.data(), num_bytes);
+}
+
+auto read_le(const uint8_t *data, int num_bytes) noexcept -> uint64_t {
+    uint64_t value = 0;
+    for (int i = 0; i < num_bytes; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);    // NOLINT(*-magic-numbers)
+    }
+    return value;
+}
+
+auto packed_size(std::size_t num_actions) noexcept -> std::size_t {
+    return (num_actions * kActionBits + 7) / 8;
+}
+
+auto read_file(const std::string &path) -> std::vector<uint8_t> {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    std::vector<uint8_t> contents(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(contents.data()), static_cast<std::streamsize>(contents.size()))) {
+        throw std::invalid_argument("Unable to read " + path);
+    }
+    return contents;
+}
+
+auto shape_size(const std::array<int, 3> &shape) noexcept -> std::size_t {
+    return static_cast<std::size_t>(shape[0]) * static_cast<std::size_t>(shape[1]) *
+           static_cast<std::size_t>(shape[2]);
+}
+}    // namespace
+
+TrajectoryRecorder::TrajectoryRecorder(const std::string &path, const CraftWorldGameState &initial_state,
+                                       int checkpoint_interval)
+    : file(path, std::ios::binary | std::ios::trunc), current(initial_state), checkpoint_interval(checkpoint_interval) {
+    if (checkpoint_interval <= 0) {
+        throw std::invalid_argument("Checkpoint interval must be positive.");
+    }
+    if (!file) {
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    file.write(kTrajectoryMagic.data(), kTrajectoryMagic.size());
+    write_le(file, kTrajectoryVersion, 4);
+    write_le(file, static_cast<uint64_t>(checkpoint_interval), 4);
+    packed_actions.reserve(packed_size(static_cast<std::size_t>(checkpoint_interval)));
+    BeginChunk();
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    try {
+        finish();
+    } catch (...) {    // NOLINT(*-empty-catch)
+        // Destructor can't report the failure, call finish() to see it
+    }
+}
+
+void TrajectoryRecorder::record(Action action) {
+    if (finished) {
+        throw std::invalid_argument("Trajectory is already finished.");
+    }
+    if (!CraftWorldGameState::is_valid_action(action)) {
+        throw std::invalid_argument("Invalid action.");
+    }
+    current.apply_action(action);
+    // Actions may straddle a byte boundary
+    const auto bit = static_cast<std::size_t>(chunk_actions) * kActionBits;
+    packed_actions.resize(packed_size(static_cast<std::size_t>(chunk_actions) + 1), 0);
+    const uint32_t value = static_cast<uint32_t>(action) << (bit % 8);
+    packed_actions[bit / 8] |= static_cast<uint8_t>(value & 0xFF);    // NOLINT(*-magic-numbers)
+    if (bit % 8 > 8 - kActionBits) {
+        packed_actions[(bit / 8) + 1] |= static_cast<uint8_t>(value >> 8);    // NOLINT(*-magic-numbers)
+    }
+    ++chunk_actions;
+    ++steps;
+    if (chunk_actions == checkpoint_interval) {
+        EndChunk();
+        BeginChunk();
+    }
+}
+
+auto TrajectoryRecorder::state() const noexcept -> const CraftWorldGameState & {
+    return current;
+}
+
+auto TrajectoryRecorder::num_steps() const noexcept -> std::size_t {
+    return steps;
+}
+
+void TrajectoryRecorder::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    EndChunk();
+    file.close();
+    if (!file) {
+        throw std::invalid_argument("Unable to write trajectory.");
+    }
+}
+
+void TrajectoryRecorder::BeginChunk() {
+    // Checkpoint is written up front, so an unfinished file still holds every completed chunk
+    checkpoint.clear();
+    current.append_bytes(checkpoint);
+    write_le(file, checkpoint.size(), 4);
+    file.write(reinterpret_cast<const char *>(checkpoint.data()), static_cast<std::streamsize>(checkpoint.size()));
+}
+
+void TrajectoryRecorder::EndChunk() {
+    write_le(file, static_cast<uint64_t>(chunk_actions), 4);
+    file.write(reinterpret_cast<const char *>(packed_actions.data()),
+               static_cast<std::streamsize>(packed_actions.size()));
+    packed_actions.clear();
+    chunk_actions = 0;
+}
+
+TrajectoryReplayer::TrajectoryReplayer(const std::string &path)
+    : contents(read_file(path)), current([&]() {
+          if (contents.size() < kTrajectoryHeaderSize ||
+              !std::equal(kTrajectoryMagic.begin(), kTrajectoryMagic.end(), contents.begin())) {
+              throw std::invalid_argument("Not a trajectory file: " + path);
+          }
+          if (read_le(contents.data() + 4, 4) != kTrajectoryVersion) {
+              throw std::invalid_argument("Unsupported trajectory version: " + path);
+          }
+          std::size_t offset = kTrajectoryHeaderSize + 4;
+          return CraftWorldGameState::read_bytes(contents, offset);
+      }()) {
+    interval = static_cast<int>(read_le(contents.data() + 8, 4));    // NOLINT(*-magic-numbers)
+    if (interval <= 0) {
+        throw std::invalid_argument("Invalid checkpoint interval: " + path);
+    }
+
+    // Index the complete chunks, stopping at a truncated one
+    std::size_t offset = kTrajectoryHeaderSize;
+    while (offset + 4 <= contents.size()) {
+        const auto checkpoint_size = static_cast<std::size_t>(read_le(contents.data() + offset, 4));
+        const std::size_t checkpoint_offset = offset + 4;
+        std::size_t actions_offset = checkpoint_offset + checkpoint_size;
+        if (actions_offset + 4 > contents.size()) {
+            break;
+        }
+        const auto num_actions = static_cast<std::size_t>(read_le(contents.data() + actions_offset, 4));
+        actions_offset += 4;
+        if (num_actions > static_cast<std::size_t>(interval) ||
+            actions_offset + packed_size(num_actions) > contents.size()) {
+            break;
+        }
+        // Only the last chunk can be partial, so seeking can find the chunk of a step by division
+        if (!checkpoint_offsets.empty() && all_actions.size() != checkpoint_offsets.size() * interval) {
+            throw std::invalid_argument("Trajectory has a partial chunk before the last: " + path);
+        }
+        for (std::size_t i = 0; i < num_actions; ++i) {
+            const std::size_t bit = i * kActionBits;
+            const std::size_t byte_idx = actions_offset + (bit / 8);
+            uint32_t value = contents[byte_idx];
+            if (bit % 8 > 8 - kActionBits) {
+                value |= static_cast<uint32_t>(contents[byte_idx + 1]) << 8;    // NOLINT(*-magic-numbers)
+            }
+            const auto action = static_cast<Action>((value >> (bit % 8)) & kActionMask);
+            if (!CraftWorldGameState::is_valid_action(action)) {
+                throw std::invalid_argument("Invalid action in trajectory: " + path);
+            }
+            all_actions.push_back(action);
+        }
+        checkpoint_offsets.push_back(checkpoint_offset);
+        offset = actions_offset + packed_size(num_actions);
+    }
+    if (checkpoint_offsets.empty()) {
+        throw std::invalid_argument("Trajectory is truncated: " + path);
+    }
+}
+
+auto TrajectoryReplayer::num_steps() const noexcept -> std::size_t {
+    return all_actions.size();
+}
+
+auto TrajectoryReplayer::checkpoint_interval() const noexcept -> int {
+    return interval;
+}
+
+auto TrajectoryReplayer::actions() const noexcept -> std::span<const Action> {
+    return all_actions;
+}
+
+void TrajectoryReplayer::seek(std::size_t step_idx) {
+    if (step_idx > num_steps()) {
+        throw std::invalid_argument("Step out of range.");
+    }
+    const auto chunk_interval = static_cast<std::size_t>(interval);
+    // A trajectory ending on a full chunk has no chunk starting at its last step
+    const auto chunk_idx = std::min(step_idx / chunk_interval, checkpoint_offsets.size() - 1);
+    const auto chunk_start = chunk_idx * chunk_interval;
+    if (step_idx < current_idx || current_idx < chunk_start) {
+        std::size_t offset = checkpoint_offsets[chunk_idx];
+        current = CraftWorldGameState::read_bytes(contents, offset);
+        current_idx = chunk_start;
+    }
+    for (; current_idx < step_idx; ++current_idx) {
+        current.apply_action(all_actions[current_idx]);
+    }
+}
+
+auto TrajectoryReplayer::step() -> bool {
+    if (current_idx == num_steps()) {
+        return false;
+    }
+    current.apply_action(all_actions[current_idx]);
+    ++current_idx;
+    return true;
+}
+
+auto TrajectoryReplayer::current_step() const noexcept -> std::size_t {
+    return current_idx;
+}
+
+auto TrajectoryReplayer::state() const noexcept -> const CraftWorldGameState & {
+    return current;
+}
+
+void TrajectoryReplayer::write_observations(std::size_t begin, std::size_t end, std::span<float> obs) {
+    CheckRange(begin, end);
+    const auto obs_size = shape_size(current.observation_shape());
+    if (obs.size() != (end - begin) * obs_size) {
+        throw std::invalid_argument("Observation buffer size does not match the number of steps.");
+    }
+    if (begin == end) {
+        return;
+    }
+    seek(begin);
+    current.write_observation(obs.subspan(0, obs_size));
+    for (std::size_t i = 1; i < end - begin; ++i) {
+        step();
+        const auto prev_obs = obs.subspan((i - 1) * obs_size, obs_size);
+        const auto next_obs = obs.subspan(i * obs_size, obs_size);
+        std::copy(prev_obs.begin(), prev_obs.end(), next_obs.begin());
+        current.update_observation(next_obs);
+    }
+}
+
+void TrajectoryReplayer::write_images(std::size_t begin, std::size_t end, std::span<uint8_t> imgs, int tile_size) {
+    CheckRange(begin, end);
+    CraftWorldRenderer renderer(tile_size);
+    const auto img_size = shape_size(current.image_shape(tile_size));
+    if (imgs.size() != (end - begin) * img_size) {
+        throw std::invalid_argument("Image buffer size does not match the number of steps.");
+    }
+    for (std::size_t i = 0; i < end - begin; ++i) {
+        if (i == 0) {
+            seek(begin);
+        } else {
+            step();
+        }
+        const auto frame = renderer.render(current);
+        std::copy(frame.begin(), frame.end(), imgs.begin() + static_cast<std::ptrdiff_t>(i * img_size));
+    }
+}
+
+void TrajectoryReplayer::CheckRange(std::size_t begin, std::size_t end) const {
+    if (begin > end || end > num_steps() + 1) {
+        throw std::invalid_argument("Step range out of range.");
+    }
+}
+
+}    // namespace craftworld
@@ -0,0 +1,167 @@
+#ifndef CRAFTWORLD_TRAJECTORY_H_
+#define CRAFTWORLD_TRAJECTORY_H_
+
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "craftworld_base.h"
+
+namespace craftworld {
+
+// Trajectory file, every integer is little-endian:
+//   0: magic "CWTR"
+//   4: uint32 format version
+//   8: uint32 checkpoint interval K
+//  12: chunks, each a checkpoint of the state before the chunk's actions, then those actions:
+//      uint32 checkpoint size, to_bytes() encoding of the state, uint32 number of actions (at most K),
+//      then the actions packed 3 bits each, action i in bits [3i, 3i + 3) counting from the low bit of byte 0
+// The first checkpoint is the initial level, and every chunk but the last holds exactly K actions.
+// A trailing chunk which was never completed, such as from a recorder which did not finish, is ignored.
+constexpr uint32_t kTrajectoryVersion = 1;
+constexpr int kDefaultCheckpointInterval = 64;
+
+// Streams an episode to a trajectory file, holding only the actions since the last checkpoint in memory
+class TrajectoryRecorder {
+public:
+    /**
+     * Create the trajectory file, overwriting any existing file, and write the initial level.
+     * @param path Path of the trajectory to write
+     * @param initial_state State the episode starts from
+     * @param checkpoint_interval Number of actions between checkpoints
+     */
+    TrajectoryRecorder(const std::string &path, const CraftWorldGameState &initial_state,
+                       int checkpoint_interval = kDefaultCheckpointInterval);
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder(TrajectoryRecorder &&) = delete;
+    auto operator=(const TrajectoryRecorder &) -> TrajectoryRecorder & = delete;
+    auto operator=(TrajectoryRecorder &&) -> TrajectoryRecorder & = delete;
+
+    /**
+     * Apply an action to the recorded state and log it.
+     * @param action Action taken
+     */
+    void record(Action action);
+
+    /**
+     * Get the recorded state, after every action recorded so far.
+     * @return Game state
+     */
+    [[nodiscard]] auto state() const noexcept -> const CraftWorldGameState &;
+
+    /**
+     * Get the number of actions recorded.
+     * @return Count of actions
+     */
+    [[nodiscard]] auto num_steps() const noexcept -> std::size_t;
+
+    /**
+     * Write the last chunk and close the file, after which no more actions can be recorded.
+     * Called by the destructor if not called before.
+     */
+    void finish();
+
+private:
+    void BeginChunk();
+    void EndChunk();
+
+    std::ofstream file;
+    CraftWorldGameState current;
+    std::vector<uint8_t> packed_actions;    // Actions of the open chunk
+    std::vector<uint8_t> checkpoint;        // Reused encoding buffer
+    int checkpoint_interval;
+    int chunk_actions = 0;
+    std::size_t steps = 0;
+    bool finished = false;
+};
+
+// Replays a trajectory file at apply_action speed, seeking through the nearest checkpoint.
+// The state at step s is the state after the first s actions, for s in [0, num_steps()].
+class TrajectoryReplayer {
+public:
+    /**
+     * Read a trajectory, starting at step 0.
+     * @param path Path of the trajectory to read
+     * @throws std::invalid_argument if the file cannot be read or is not a trajectory
+     */
+    explicit TrajectoryReplayer(const std::string &path);
+
+    /**
+     * Get the number of actions in the trajectory.
+     * @return Count of actions
+     */
+    [[nodiscard]] auto num_steps() const noexcept -> std::size_t;
+
+    /**
+     * Get the number of actions between checkpoints.
+     * @return Checkpoint interval
+     */
+    [[nodiscard]] auto checkpoint_interval() const noexcept -> int;
+
+    /**
+     * Get every action of the trajectory.
+     * @return Actions in order
+     */
+    [[nodiscard]] auto actions() const noexcept -> std::span<const Action>;
+
+    /**
+     * Move to a step, replaying from the nearest checkpoint at or before it unless it is ahead in the same chunk.
+     * @param step Step to move to, at most num_steps()
+     */
+    void seek(std::size_t step);
+
+    /**
+     * Apply the next action.
+     * @return False if already at the last step, true otherwise
+     */
+    auto step() -> bool;
+
+    /**
+     * Get the step of the current state.
+     * @return Current step
+     */
+    [[nodiscard]] auto current_step() const noexcept -> std::size_t;
+
+    /**
+     * Get the current state.
+     * @return Game state at current_step()
+     */
+    [[nodiscard]] auto state() const noexcept -> const CraftWorldGameState &;
+
+    /**
+     * Write the stacked observations of the states at steps [begin, end), leaving the replayer at end - 1.
+     * Each observation after the first is patched from the previous one with update_observation().
+     * @param begin First step
+     * @param end One past the last step, at most num_steps() + 1
+     * @param obs Buffer of size (end - begin)*C*H*W from the state's observation_shape()
+     */
+    void write_observations(std::size_t begin, std::size_t end, std::span<float> obs);
+
+    /**
+     * Write the stacked images of the states at steps [begin, end), leaving the replayer at end - 1.
+     * Frames are drawn by a CraftWorldRenderer, so only the tiles changed by each step are redrawn.
+     * @param begin First step
+     * @param end One past the last step, at most num_steps() + 1
+     * @param imgs Buffer of size (end - begin)*H*W*C from the state's image_shape(tile_size)
+     * @param tile_size Width/height of each tile in pixels
+     */
+    void write_images(std::size_t begin, std::size_t end, std::span<uint8_t> imgs, int tile_size = SPRITE_WIDTH);
+
+private:
+    void CheckRange(std::size_t begin, std::size_t end) const;
+
+    std::vector<uint8_t> contents;
+    std::vector<std::size_t> checkpoint_offsets;    // Offset of each chunk's checkpoint encoding
+    std::vector<Action> all_actions;
+    int interval = kDefaultCheckpointInterval;
+    CraftWorldGameState current;
+    std::size_t current_idx = 0;
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_TRAJECTORY_H_
@@ -0,0 +1,125 @@
+#include "craftworld_vec_env.h"
+
+#include <stdexcept>
+
+namespace craftworld {
+
+CraftWorldVecEnv::CraftWorldVecEnv(const std::vector<std::string> &board_strs, int num_envs, int num_threads,
+                                   uint64_t seed)
+    : pool(num_threads) {
+    if (board_strs.empty()) {
+        throw std::invalid_argument("At least one level is required.");
+    }
+    if (num_envs <= 0) {
+        throw std::invalid_argument("Number of environments must be positive.");
+    }
+    levels.reserve(board_strs.size());
+    for (const auto &board_str : board_strs) {
+        levels.emplace_back(board_str);
+        if (levels.back().observation_shape() != levels.front().observation_shape()) {
+            throw std::invalid_argument("All levels must have the same rows/cols.");
+        }
+    }
+
+    const auto [c, h, w] = levels.front().observation_shape();
+    obs_size = static_cast<std::size_t>(c) * static_cast<std::size_t>(h) * static_cast<std::size_t>(w);
+    const auto n = static_cast<std::size_t>(num_envs);
+    states.assign(n, levels.front());
+    rngs.reserve(n);
+    std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+    std::vector<uint64_t> env_seeds(n);
+    seq.generate(env_seeds.begin(), env_seeds.end());
+    for (const auto &env_seed : env_seeds) {
+        rngs.emplace_back(env_seed);
+    }
+    obs_buffer.resize(n * obs_size, 0);
+    reward_buffer.resize(n, 0);
+    done_buffer.resize(n, 0);
+    mask_buffer.resize(n, 0);
+    reset();
+}
+
+void CraftWorldVecEnv::reset() {
+    pool.parallel_for(states.size(), [this](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            ResetEnv(i);
+            reward_buffer[i] = 0;
+            done_buffer[i] = 0;
+            WriteObservation(i);
+            mask_buffer[i] = states[i].effective_action_mask();
+        }
+    });
+}
+
+void CraftWorldVecEnv::step(std::span<const int> actions) {
+    if (actions.size() != states.size()) {
+        throw std::invalid_argument("Number of actions does not match number of environments.");
+    }
+    for (const auto &action : actions) {
+        if (!CraftWorldGameState::is_valid_action(static_cast<Action>(action))) {
+            throw std::invalid_argument("Invalid action.");
+        }
+    }
+    pool.parallel_for(states.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto &state = states[i];
+            state.apply_action(static_cast<Action>(actions[i]));
+            reward_buffer[i] = state.get_reward_signal();
+            done_buffer[i] = static_cast<uint8_t>(state.is_solution());
+            if (done_buffer[i]) {
+                ResetEnv(i);
+                WriteObservation(i);
+            } else {
+                // Buffer holds the observation from before this step
+                state.update_observation(ObservationSpan(i));
+            }
+            mask_buffer[i] = states[i].effective_action_mask();
+        }
+    });
+}
+
+auto CraftWorldVecEnv::num_envs() const noexcept -> int {
+    return static_cast<int>(states.size());
+}
+
+auto CraftWorldVecEnv::observation_shape() const noexcept -> std::array<int, 3> {
+    return levels.front().observation_shape();
+}
+
+auto CraftWorldVecEnv::observations() const noexcept -> std::span<const float> {
+    return obs_buffer;
+}
+
+auto CraftWorldVecEnv::reward_signals() const noexcept -> std::span<const uint64_t> {
+    return reward_buffer;
+}
+
+auto CraftWorldVecEnv::dones() const noexcept -> std::span<const uint8_t> {
+    return done_buffer;
+}
+
+auto CraftWorldVecEnv::action_masks() const noexcept -> std::span<const uint8_t> {
+    return mask_buffer;
+}
+
+auto CraftWorldVecEnv::get_state(int env_idx) const -> const CraftWorldGameState & {
+    if (env_idx < 0 || env_idx >= num_envs()) {
+        throw std::invalid_argument("Environment index out of range.");
+    }
+    return states[static_cast<std::size_t>(env_idx)];
+}
+
+void CraftWorldVecEnv::ResetEnv(std::size_t env_idx) {
+    std::uniform_int_distribution<std::size_t> dist(0, levels.size() - 1);
+    states[env_idx] = levels[dist(rngs[env_idx])];
+}
+
+void CraftWorldVecEnv::WriteObservation(std::size_t env_idx) {
+    states[env_idx].write_observation(ObservationSpan(env_idx));
+}
+
+auto CraftWorldVecEnv::ObservationSpan(std::size_t env_idx) noexcept -> std::span<float> {
+    return std::span<float>(obs_buffer).subspan(env_idx * obs_size, obs_size);
+}
+
+}    // namespace craftworld
@@ -0,0 +1,103 @@
+#ifndef CRAFTWORLD_VEC_ENV_H_
+#define CRAFTWORLD_VEC_ENV_H_
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "craftworld_base.h"
+#include "thread_pool.h"
+
+namespace craftworld {
+
+// Batch of game states stepped together, with outputs written into contiguous buffers
+class CraftWorldVecEnv {
+public:
+    /**
+     * Create the environments.
+     * @param board_strs Levels to sample from when an environment is reset, all of the same dimensions
+     * @param num_envs Number of environments
+     * @param num_threads Number of threads used when stepping, including the calling thread
+     * @param seed Seed for the per environment level sampling
+     */
+    CraftWorldVecEnv(const std::vector<std::string> &board_strs, int num_envs, int num_threads = 1,
+                     uint64_t seed = 0);
+
+    /**
+     * Reset every environment to a newly sampled level, and write the observations.
+     */
+    void reset();
+
+    /**
+     * Apply one action to each environment, then write the observations, reward signals and done flags.
+     * Environments which reach the solution are reset to a newly sampled level, so the written
+     * observation for those environments is the start of the next episode.
+     * @param actions One action per environment
+     */
+    void step(std::span<const int> actions);
+
+    /**
+     * Get the number of environments.
+     * @return Count of environments
+     */
+    [[nodiscard]] auto num_envs() const noexcept -> int;
+
+    /**
+     * Get the shape a single environment observation should be viewed as.
+     * @return array indicating observation CHW
+     */
+    [[nodiscard]] auto observation_shape() const noexcept -> std::array<int, 3>;
+
+    /**
+     * Get the observations of all environments, each viewed as the shape given by observation_shape().
+     * @return contiguous observations, overwritten by the next call to step() or reset()
+     */
+    [[nodiscard]] auto observations() const noexcept -> std::span<const float>;
+
+    /**
+     * Get the reward signals from the previous step.
+     * @return one reward signal per environment
+     */
+    [[nodiscard]] auto reward_signals() const noexcept -> std::span<const uint64_t>;
+
+    /**
+     * Get the done flags from the previous step.
+     * @return one flag per environment, 1 if the episode reached the solution
+     */
+    [[nodiscard]] auto dones() const noexcept -> std::span<const uint8_t>;
+
+    /**
+     * Get the effective_action_mask() of each current state, as of the last step() or reset().
+     * @return one mask per environment
+     */
+    [[nodiscard]] auto action_masks() const noexcept -> std::span<const uint8_t>;
+
+    /**
+     * Get the current state of an environment.
+     * @param env_idx Index of the environment
+     * @return Game state
+     */
+    [[nodiscard]] auto get_state(int env_idx) const -> const CraftWorldGameState &;
+
+private:
+    void ResetEnv(std::size_t env_idx);
+    void WriteObservation(std::size_t env_idx);
+    auto ObservationSpan(std::size_t env_idx) noexcept -> std::span<float>;
+
+    std::vector<CraftWorldGameState> levels;
+    std::vector<CraftWorldGameState> states;
+    std::vector<std::mt19937_64> rngs;
+    std::vector<float> obs_buffer;
+    std::vector<uint64_t> reward_buffer;
+    std::vector<uint8_t> done_buffer;
+    std::vector<uint8_t> mask_buffer;
+    std::size_t obs_size = 0;
+    ThreadPool pool;
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_VEC_ENV_H_
@@ -4,9 +4,11 @@
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <initializer_list>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace craftworld {
@@ -226,6 +228,140 @@ const std::unordered_map<Element, RewardCode> kWorkstationRewardMap{
     {Element::kFurnace, RewardCode::kRewardCodeUseAtFurnace},
 };
 
+// ---------------------------------------------------------------------------
+// Compile-time lookup tables used when stepping, indexed by Element or RecipeType value.
+// These hold the same data as the maps above.
+
+constexpr int kMaxRecipeInputs = 3;
+constexpr int kMaxRecipesPerWorkshop = 4;
+
+struct RecipeDef {
+    RecipeType recipe;
+    Element location;
+    Element output;
+    std::array<RecipeInputItem, kMaxRecipeInputs> inputs;
+    int num_inputs;
+    uint64_t reward;    // Craft reward combined with the workshop reward
+};
+
+namespace detail {
+template <typename T, std::size_t N>
+constexpr auto make_element_table(const std::array<std::pair<Element, T>, N> &entries) -> std::array<T, kNumElements> {
+    std::array<T, kNumElements> table{};
+    for (const auto &[element, value] : entries) {
+        table[static_cast<std::size_t>(element)] = value;
+    }
+    return table;
+}
+
+constexpr auto make_recipe(RecipeType recipe, std::initializer_list<RecipeInputItem> inputs, Element location,
+                           Element output, RewardCode craft_reward, RewardCode workshop_reward) -> RecipeDef {
+    RecipeDef def{recipe, location, output, {}, 0,
+                  static_cast<uint64_t>(craft_reward) | static_cast<uint64_t>(workshop_reward)};
+    for (const auto &input : inputs) {
+        def.inputs[static_cast<std::size_t>(def.num_inputs++)] = input;
+    }
+    return def;
+}
+}    // namespace detail
+
+// Recipes indexed by RecipeType, matching the kRecipe* definitions and kRecipeRewardMap
+// (including kBronzePick giving kRewardCodeCraftBronzeHammer)
+constexpr std::array<RecipeDef, kNumRecipeTypes> kRecipes{
+    detail::make_recipe(RecipeType::kBronzeBar, {{Element::kCopper, 1}, {Element::kTin, 1}}, Element::kFurnace,
+                        Element::kBronzeBar, RewardCode::kRewardCodeCraftBronzeBar,
+                        RewardCode::kRewardCodeUseAtFurnace),
+    detail::make_recipe(RecipeType::kStick, {{Element::kWood, 1}}, Element::kWorkshop1, Element::kStick,
+                        RewardCode::kRewardCodeCraftStick, RewardCode::kRewardCodeUseAtWorkstation1),
+    detail::make_recipe(RecipeType::kPlank, {{Element::kWood, 1}}, Element::kWorkshop3, Element::kPlank,
+                        RewardCode::kRewardCodeCraftPlank, RewardCode::kRewardCodeUseAtWorkstation3),
+    detail::make_recipe(RecipeType::kRope, {{Element::kGrass, 1}}, Element::kWorkshop2, Element::kRope,
+                        RewardCode::kRewardCodeCraftRope, RewardCode::kRewardCodeUseAtWorkstation2),
+    detail::make_recipe(RecipeType::kNails, {{Element::kBronzeBar, 1}}, Element::kWorkshop1, Element::kNails,
+                        RewardCode::kRewardCodeCraftNails, RewardCode::kRewardCodeUseAtWorkstation1),
+    detail::make_recipe(RecipeType::kBronzeHammer, {{Element::kBronzeBar, 1}, {Element::kStick, 1}},
+                        Element::kWorkshop2, Element::kBronzeHammer, RewardCode::kRewardCodeCraftBronzeHammer,
+                        RewardCode::kRewardCodeUseAtWorkstation2),
+    detail::make_recipe(RecipeType::kBronzePick, {{Element::kBronzeBar, 1}, {Element::kStick, 1}},
+                        Element::kWorkshop3, Element::kBronzePick, RewardCode::kRewardCodeCraftBronzeHammer,
+                        RewardCode::kRewardCodeUseAtWorkstation3),
+    detail::make_recipe(RecipeType::kBridge,
+                        {{Element::kPlank, 1}, {Element::kNails, 1}, {Element::kBronzeHammer, 1}},
+                        Element::kWorkshop1, Element::kBridge, RewardCode::kRewardCodeCraftBridge,
+                        RewardCode::kRewardCodeUseAtWorkstation1),
+    detail::make_recipe(RecipeType::kIronPick, {{Element::kIron, 1}, {Element::kStick, 1}}, Element::kWorkshop3,
+                        Element::kIronPick, RewardCode::kRewardCodeCraftIronPick,
+                        RewardCode::kRewardCodeUseAtWorkstation3),
+    detail::make_recipe(RecipeType::kGoldBar, {{Element::kGold, 1}}, Element::kWorkshop1, Element::kGoldBar,
+                        RewardCode::kRewardCodeCraftGoldBar, RewardCode::kRewardCodeUseAtWorkstation1),
+    detail::make_recipe(RecipeType::kGemRing, {{Element::kGem, 1}}, Element::kWorkshop2, Element::kGemRing,
+                        RewardCode::kRewardCodeCraftGemRing, RewardCode::kRewardCodeUseAtWorkstation2),
+};
+
+static_assert(
+    []() {
+        for (std::size_t i = 0; i < kRecipes.size(); ++i) {
+            if (static_cast<std::size_t>(kRecipes[i].recipe) != i) {
+                return false;
+            }
+        }
+        return true;
+    }(),
+    "kRecipes must be indexed by RecipeType");
+
+// Recipes which can be crafted, in the order they are tried: decreasing RecipeType, so higher tier items win when
+// several recipes at a workshop have their ingredients held. Rope is not craftable (it is absent from kRecipeMap).
+constexpr std::array<RecipeType, kNumRecipeTypes - 1> kCraftOrder{
+    RecipeType::kGemRing,      RecipeType::kGoldBar,     RecipeType::kIronPick,
+    RecipeType::kBridge,       RecipeType::kBronzePick,  RecipeType::kBronzeHammer,
+    RecipeType::kNails,        RecipeType::kPlank,       RecipeType::kStick,
+    RecipeType::kBronzeBar,
+};
+
+// Craftable recipes per workshop element, in kCraftOrder. Using a workshop crafts the first one whose
+// ingredients are all in the inventory, and nothing otherwise.
+struct WorkshopRecipes {
+    std::array<RecipeType, kMaxRecipesPerWorkshop> recipes;
+    int num_recipes;
+};
+constexpr auto kWorkshopRecipes = []() {
+    std::array<WorkshopRecipes, kNumElements> table{};
+    for (const auto &recipe : kCraftOrder) {
+        auto &entry = table[static_cast<std::size_t>(kRecipes[static_cast<std::size_t>(recipe)].location)];
+        entry.recipes[static_cast<std::size_t>(entry.num_recipes++)] = recipe;
+    }
+    return table;
+}();
+
+// Elements which are workshops
+constexpr auto kIsWorkShop = detail::make_element_table<bool, 4>({{
+    {Element::kWorkshop1, true},
+    {Element::kWorkshop2, true},
+    {Element::kWorkshop3, true},
+    {Element::kFurnace, true},
+}});
+
+// Elements which are collected without a tool
+constexpr auto kIsPrimitive = detail::make_element_table<bool, 6>({{
+    {Element::kGrass, true},
+    {Element::kWood, true},
+    {Element::kGold, true},
+    {Element::kGem, true},
+    {Element::kCopper, true},
+    {Element::kTin, true},
+}});
+
+// Reward for collecting each primitive element, 0 if not collectable
+constexpr auto kCollectReward = detail::make_element_table<uint64_t, 7>({{
+    {Element::kTin, static_cast<uint64_t>(RewardCode::kRewardCodeCollectTin)},
+    {Element::kCopper, static_cast<uint64_t>(RewardCode::kRewardCodeCollectCopper)},
+    {Element::kWood, static_cast<uint64_t>(RewardCode::kRewardCodeCollectWood)},
+    {Element::kGrass, static_cast<uint64_t>(RewardCode::kRewardCodeCollectGrass)},
+    {Element::kIron, static_cast<uint64_t>(RewardCode::kRewardCodeCollectIron)},
+    {Element::kGold, static_cast<uint64_t>(RewardCode::kRewardCodeCollectGold)},
+    {Element::kGem, static_cast<uint64_t>(RewardCode::kRewardCodeCollectGem)},
+}});
+
 const std::unordered_map<Element, std::string> kElementToSymbolMap{
     {Element::kAgent, "@"},    // Env
     {Element::kWall, "#"},      {Element::kWorkshop1, "1"}, {Element::kWorkshop2, "2"},
@@ -0,0 +1,176 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace craftworld {
+
+namespace {
+// Chunks handed out per thread, so uneven chunk costs still balance out
+constexpr std::size_t kChunksPerThread = 4;
+
+constexpr int kRangeShift = 32;
+constexpr uint64_t kRangeMask = (uint64_t{1} << kRangeShift) - 1;
+
+auto pack_range(std::size_t begin, std::size_t end) noexcept -> uint64_t {
+    return (static_cast<uint64_t>(begin) << kRangeShift) | static_cast<uint64_t>(end);
+}
+}    // namespace
+
+ThreadPool::ThreadPool(int num_threads)
+    : steal_ranges(std::make_unique<StealRange[]>(static_cast<std::size_t>(std::max(num_threads, 1)))) {    // NOLINT
+    for (int i = 1; i < num_threads; ++i) {
+        workers.emplace_back([this, i]() { WorkerLoop(static_cast<std::size_t>(i)); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv_start.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+auto ThreadPool::num_threads() const noexcept -> int {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::parallel_for(std::size_t n, const RangeFunc &func) {
+    if (n == 0) {
+        return;
+    }
+    // Not worth waking the workers
+    if (workers.empty() || n == 1) {
+        func(0, n);
+        return;
+    }
+
+    const std::size_t num_chunks = static_cast<std::size_t>(num_threads()) * kChunksPerThread;
+    stealing = false;
+    chunk_size = std::max<std::size_t>(1, (n + num_chunks - 1) / num_chunks);
+    next_chunk.store(0, std::memory_order_relaxed);
+    Dispatch(n, func);
+}
+
+void ThreadPool::parallel_for_stealing(std::size_t n, const RangeFunc &func, std::size_t grain) {
+    if (n == 0) {
+        return;
+    }
+    // Ranges are packed into 32 bits each
+    if (workers.empty() || n == 1 || n > kRangeMask) {
+        parallel_for(n, func);
+        return;
+    }
+    const auto threads = static_cast<std::size_t>(num_threads());
+    stealing = true;
+    chunk_size = std::max<std::size_t>(1, grain);
+    for (std::size_t i = 0; i < threads; ++i) {
+        steal_ranges[i].range.store(pack_range(n * i / threads, n * (i + 1) / threads), std::memory_order_relaxed);
+    }
+    Dispatch(n, func);
+}
+
+void ThreadPool::Dispatch(std::size_t n, const RangeFunc &func) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &func;
+        job_size = n;
+        active_workers = workers.size();
+        ++generation;
+    }
+    cv_start.notify_all();
+
+    // Calling thread takes part in the work
+    RunJob(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv_done.wait(lock, [this]() { return active_workers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerLoop(std::size_t thread_idx) {
+    uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv_start.wait(lock, [&]() { return stop || generation != seen_generation; });
+            if (stop) {
+                return;
+            }
+            seen_generation = generation;
+        }
+        RunJob(thread_idx);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active_workers == 0) {
+                cv_done.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::RunJob(std::size_t thread_idx) {
+    if (stealing) {
+        RunStealing(thread_idx);
+    } else {
+        RunChunks();
+    }
+}
+
+void ThreadPool::RunChunks() {
+    while (true) {
+        const std::size_t begin = next_chunk.fetch_add(1, std::memory_order_relaxed) * chunk_size;
+        if (begin >= job_size) {
+            return;
+        }
+        (*job)(begin, std::min(begin + chunk_size, job_size));
+    }
+}
+
+void ThreadPool::RunStealing(std::size_t thread_idx) {
+    auto &own = steal_ranges[thread_idx].range;
+    do {
+        uint64_t range = own.load(std::memory_order_acquire);
+        while (true) {
+            const auto begin = static_cast<std::size_t>(range >> kRangeShift);
+            const auto end = static_cast<std::size_t>(range & kRangeMask);
+            if (begin >= end) {
+                break;
+            }
+            const std::size_t grain_end = std::min(begin + chunk_size, end);
+            // On failure a thief took the back of the share, and range is reloaded
+            if (own.compare_exchange_weak(range, pack_range(grain_end, end), std::memory_order_acq_rel)) {
+                (*job)(begin, grain_end);
+                range = own.load(std::memory_order_acquire);
+            }
+        }
+    } while (Steal(thread_idx));
+}
+
+auto ThreadPool::Steal(std::size_t thread_idx) -> bool {
+    // Own share is empty, so thieves never take from it and only this thread writes it
+    const auto threads = static_cast<std::size_t>(num_threads());
+    for (std::size_t offset = 1; offset < threads; ++offset) {
+        auto &victim = steal_ranges[(thread_idx + offset) % threads].range;
+        uint64_t range = victim.load(std::memory_order_acquire);
+        while (true) {
+            const auto begin = static_cast<std::size_t>(range >> kRangeShift);
+            const auto end = static_cast<std::size_t>(range & kRangeMask);
+            if (begin >= end) {
+                break;
+            }
+            // A single remaining index is taken whole
+            const std::size_t mid = begin + ((end - begin) / 2);
+            if (victim.compare_exchange_weak(range, pack_range(begin, mid), std::memory_order_acq_rel)) {
+                steal_ranges[thread_idx].range.store(pack_range(mid, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}    // namespace craftworld
@@ -0,0 +1,89 @@
+#ifndef CRAFTWORLD_THREAD_POOL_H_
+#define CRAFTWORLD_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace craftworld {
+
+// Persistent pool of worker threads used to split batched work
+class ThreadPool {
+public:
+    using RangeFunc = std::function<void(std::size_t, std::size_t)>;
+
+    /**
+     * Create the pool.
+     * @param num_threads Total number of threads working on a job, including the calling thread
+     */
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+    auto operator=(ThreadPool &&) -> ThreadPool & = delete;
+
+    /**
+     * Get the number of threads working on a job, including the calling thread.
+     * @return Thread count
+     */
+    [[nodiscard]] auto num_threads() const noexcept -> int;
+
+    /**
+     * Run func over the range [0, n), split into contiguous chunks [begin, end) across the pool.
+     * Blocks until every chunk is complete. func must not throw, and only one thread may dispatch at a time.
+     * @param n Size of the range
+     * @param func Callable invoked as func(begin, end) on each chunk
+     */
+    void parallel_for(std::size_t n, const RangeFunc &func);
+
+    /**
+     * Run func over the range [0, n) with work stealing, for items of very uneven cost.
+     * Each thread starts on an equal contiguous share which it runs grain indices at a time,
+     * then steals the back half of what remains of another thread's share until none is left.
+     * Same requirements on func as parallel_for().
+     * @param n Size of the range
+     * @param func Callable invoked as func(begin, end) on each grain
+     * @param grain Number of indices run per call of func
+     */
+    void parallel_for_stealing(std::size_t n, const RangeFunc &func, std::size_t grain = 1);
+
+private:
+    // Indices [begin, end) not yet taken from a thread's share, packed as begin << 32 | end so the owner
+    // and thieves claim indices with a single compare-and-swap
+    struct alignas(64) StealRange {    // NOLINT(*-magic-numbers)
+        std::atomic<uint64_t> range{0};
+    };
+
+    void Dispatch(std::size_t n, const RangeFunc &func);
+    void WorkerLoop(std::size_t thread_idx);
+    void RunJob(std::size_t thread_idx);
+    void RunChunks();
+    void RunStealing(std::size_t thread_idx);
+    auto Steal(std::size_t thread_idx) -> bool;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cv_start;
+    std::condition_variable cv_done;
+    const RangeFunc *job = nullptr;
+    std::size_t job_size = 0;
+    std::size_t chunk_size = 1;
+    std::atomic<std::size_t> next_chunk{0};
+    bool stealing = false;
+    std::unique_ptr<StealRange[]> steal_ranges;    // NOLINT(*-avoid-c-arrays)
+    std::size_t active_workers = 0;
+    uint64_t generation = 0;
+    bool stop = false;
+};
+
+}    // namespace craftworld
+
+#endif    // CRAFTWORLD_THREAD_POOL_H_
@@ -0,0 +1,60 @@
+// test_action_mask.cpp
+// effective_action_mask() sets exactly the actions which change the state when applied
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+// Mask found the slow way, applying each action to a copy
+auto applied_mask(const CraftWorldGameState &state) -> uint8_t {
+    uint8_t mask = 0;
+    for (int action = 0; action < kNumActions; ++action) {
+        auto next = state;
+        next.apply_action(static_cast<Action>(action));
+        if (next != state) {
+            mask |= static_cast<uint8_t>(1U << static_cast<unsigned>(action));
+        }
+    }
+    return mask;
+}
+
+void test_effective_action_mask() {
+    std::mt19937 rng(0);
+    for (auto state : start_states()) {
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            CHECK(state.effective_action_mask() == applied_mask(state));
+            state.apply_action(walk_action(state, rng));
+        }
+    }
+}
+
+// Batched masks match the mask of each state
+void test_write_action_masks() {
+    std::mt19937 rng(0);
+    auto states = start_states();
+    for (auto &state : states) {
+        for (int i = 0; i < 20; ++i) {
+            state.apply_action(walk_action(state, rng));
+        }
+    }
+    std::vector<const CraftWorldGameState *> state_ptrs;
+    for (const auto &state : states) {
+        state_ptrs.push_back(&state);
+    }
+    std::vector<uint8_t> masks(states.size());
+    write_action_masks(state_ptrs, masks);
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        CHECK(masks[i] == applied_mask(states[i]));
+    }
+}
+
+}    // namespace
+
+int main() {
+    test_effective_action_mask();
+    test_write_action_masks();
+    return finish("test_action_mask");
+}
@@ -0,0 +1,74 @@
+// test_arena.cpp
+// States stored in a StateArena rebuild to the states stored
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+void check_rebuilt(const StateArena &arena, StateHandle handle, const CraftWorldGameState &state) {
+    const auto rebuilt = arena.get(handle);
+    CHECK(rebuilt == state);
+    CHECK(rebuilt.get_hash() == state.get_hash());
+    CHECK(rebuilt.get_hash128() == state.get_hash128());
+    CHECK(rebuilt.get_reward_signal() == state.get_reward_signal());
+    CHECK(rebuilt.get_observation() == state.get_observation());
+    CHECK(arena.get_hash(handle) == state.get_hash());
+    CHECK(arena.equals(handle, state));
+}
+
+// Every state along a walk is stored, then each is rebuilt after the arena has grown past it
+void test_store_and_rebuild() {
+    std::mt19937 rng(0);
+    for (auto state : start_states()) {
+        StateArena arena(state);
+        std::vector<CraftWorldGameState> stored;
+        std::vector<StateHandle> handles;
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            handles.push_back(arena.add(state));
+            stored.push_back(state);
+            state.apply_action(walk_action(state, rng));
+        }
+        CHECK(arena.size() == handles.size());
+        CHECK(arena.memory_usage() >= arena.size() * arena.slot_size());
+        auto rebuilt = stored.front();
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            check_rebuilt(arena, handles[i], stored[i]);
+            arena.load(handles[i], rebuilt);
+            CHECK(rebuilt == stored[i]);
+            CHECK(rebuilt.get_hash() == stored[i].get_hash());
+            // A state differing only in the agent position is not equal
+            if (i > 0 && stored[i].get_agent_index() != stored[i - 1].get_agent_index()) {
+                CHECK(!arena.equals(handles[i], stored[i - 1]));
+            }
+        }
+    }
+}
+
+// clone() copies a slot which store() then overwrites, as a search builds children
+void test_clone_and_store() {
+    std::mt19937 rng(0);
+    for (const auto &level : start_states()) {
+        StateArena arena(level);
+        const auto parent = arena.add(level);
+        const auto child = arena.clone(parent);
+        check_rebuilt(arena, child, level);
+        auto child_state = level;
+        child_state.apply_action(walk_action(child_state, rng));
+        arena.store(child, child_state);
+        check_rebuilt(arena, child, child_state);
+        check_rebuilt(arena, parent, level);
+        arena.clear();
+        CHECK(arena.size() == 0);
+    }
+}
+
+}    // namespace
+
+int main() {
+    test_store_and_rebuild();
+    test_clone_and_store();
+    return finish("test_arena");
+}
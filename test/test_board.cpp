@@ -0,0 +1,60 @@
+// test_board.cpp
+// Boards past the inline limit, stored on the heap, behave as inline boards do
+
+#include <utility>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+void check_same(const CraftWorldGameState &state, const CraftWorldGameState &expected) {
+    CHECK(state == expected);
+    CHECK(state.get_hash() == expected.get_hash());
+    CHECK(state.get_hash128() == expected.get_hash128());
+    CHECK(state.get_reward_signal() == expected.get_reward_signal());
+}
+
+// Copies, moves, undo, encoding and observation patches along walks on boards either side of the limit
+void test_board_sizes() {
+    std::mt19937 rng(0);
+    const auto small = start_states()[0];
+    for (const int map_size : {kMaxInlineBoardDim, kMaxInlineBoardDim + 1, 64}) {
+        auto state = generate_levels({.map_size = map_size}, 1, 0)[0];
+        CHECK(state.get_board_shape() == (std::array<int, 2>{map_size, map_size}));
+        std::vector<float> obs = state.get_observation();
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            const auto before = state;
+            const auto record = state.apply_action_with_undo(walk_action(state, rng));
+            state.update_observation(obs);
+            CHECK(obs == state.get_observation());
+            // Copy assign over a state of the same size, and move assign over a small inline one
+            auto copy = before;
+            copy = state;
+            check_same(copy, state);
+            auto moved = small;
+            moved = std::move(copy);
+            check_same(moved, state);
+            check_same(CraftWorldGameState::from_bytes(state.to_bytes()), state);
+            auto undone = state;
+            undone.undo(record);
+            check_same(undone, before);
+        }
+    }
+}
+
+void test_board_limits() {
+    const std::vector<uint8_t> cells(static_cast<std::size_t>(kMaxBoardDim + 1), static_cast<uint8_t>(Element::kEmpty));
+    CHECK_THROWS((CraftWorldGameState{1, kMaxBoardDim + 1, Element::kGemRing, cells}), std::invalid_argument);
+    CHECK_THROWS((CraftWorldGameState{0, 1, Element::kGemRing, {}}), std::invalid_argument);
+}
+
+}    // namespace
+
+int main() {
+    test_board_sizes();
+    test_board_limits();
+    return finish("test_board");
+}
@@ -0,0 +1,121 @@
+// test_distance.cpp
+// A DistanceCache kept across a walk gives the distances of a BFS run from scratch on each state
+
+#include <array>
+#include <deque>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+/**
+ * Distance field of an element found with a plain BFS over the board, the board edge counting as kWall.
+ * @param state State to measure on
+ * @param element Element to reach
+ * @return Distance for each cell in row-major order, kUnreachable where the agent cannot stand
+ */
+auto bfs_field(const CraftWorldGameState &state, Element element) -> std::vector<int> {
+    const auto [rows, cols] = state.get_board_shape();
+    const auto walkable = [&](int row, int col) {
+        const auto cell = state.get_element(row * cols + col);
+        return cell == Element::kEmpty || cell == Element::kAgent;
+    };
+    const auto holds_element = [&](int row, int col) {
+        if (row < 0 || row >= rows || col < 0 || col >= cols) {
+            return element == Element::kWall;
+        }
+        return state.get_element(row * cols + col) == element;
+    };
+    constexpr std::array<std::array<int, 2>, 4> kOffsets{{{-1, 0}, {0, 1}, {1, 0}, {0, -1}}};
+    std::vector<int> field(static_cast<std::size_t>(rows * cols), kUnreachable);
+    std::deque<int> queue;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            if (!walkable(row, col)) {
+                continue;
+            }
+            for (const auto &[d_row, d_col] : kOffsets) {
+                if (holds_element(row + d_row, col + d_col)) {
+                    field[static_cast<std::size_t>(row * cols + col)] = 0;
+                    queue.push_back(row * cols + col);
+                    break;
+                }
+            }
+        }
+    }
+    while (!queue.empty()) {
+        const int index = queue.front();
+        queue.pop_front();
+        for (const auto &[d_row, d_col] : kOffsets) {
+            const int row = index / cols + d_row;
+            const int col = index % cols + d_col;
+            if (row < 0 || row >= rows || col < 0 || col >= cols || !walkable(row, col)) {
+                continue;
+            }
+            auto &dist = field[static_cast<std::size_t>(row * cols + col)];
+            if (dist == kUnreachable) {
+                dist = field[static_cast<std::size_t>(index)] + 1;
+                queue.push_back(row * cols + col);
+            }
+        }
+    }
+    return field;
+}
+
+// One cache follows the walk, so its fields must be rebuilt as cells are removed
+void test_distance_cache() {
+    std::mt19937 rng(0);
+    DistanceCache cache;
+    for (auto state : start_states()) {
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            // A quarter of the elements each step, so every field is checked both before and after removals
+            for (int el = static_cast<int>(Element::kWall); el < static_cast<int>(Element::kEmpty); ++el) {
+                if ((el + i) % 4 != 0) {
+                    continue;
+                }
+                const auto element = static_cast<Element>(el);
+                const auto field = bfs_field(state, element);
+                CHECK(cache.get_distance_field(state, element) == field);
+                CHECK(cache.distance_to_nearest(state, element) ==
+                      field[static_cast<std::size_t>(state.get_agent_index())]);
+            }
+            state.apply_action(walk_action(state, rng));
+        }
+    }
+}
+
+// Undoing a removal returns to the board from before it, which must not be given the fields built after it
+void test_distance_cache_undo() {
+    std::mt19937 rng(0);
+    DistanceCache cache;
+    for (auto state : start_states()) {
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            const auto record = state.apply_action_with_undo(walk_action(state, rng));
+            (void)cache.distance_to_nearest(state, Element::kWorkshop1);
+            state.undo(record);
+            CHECK(cache.get_distance_field(state, Element::kWorkshop1) == bfs_field(state, Element::kWorkshop1));
+            state.apply_action(walk_action(state, rng));
+        }
+    }
+}
+
+void test_invalid_targets() {
+    DistanceCache cache;
+    const auto state = start_states()[0];
+    CHECK_THROWS((void)cache.distance_to_nearest(state, Element::kAgent), std::invalid_argument);
+    CHECK_THROWS((void)cache.distance_to_nearest(state, Element::kEmpty), std::invalid_argument);
+    cache.clear();
+    CHECK(cache.get_distance_field(state, Element::kWall) == bfs_field(state, Element::kWall));
+}
+
+}    // namespace
+
+int main() {
+    test_distance_cache();
+    test_distance_cache_undo();
+    test_invalid_targets();
+    return finish("test_distance");
+}
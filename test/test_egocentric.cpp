@@ -0,0 +1,134 @@
+// test_egocentric.cpp
+// Agent-centred observations are crops of the full observation with walls outside the board, and the inventory
+// observation matches the slots shown in the full observation's border
+
+#include <algorithm>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+// Element shown in each inventory slot of the full observation border, with the count filling it
+struct InventorySlot {
+    Element element;
+    int min_count;
+};
+constexpr std::array<InventorySlot, kInventoryObservationSize> kInventorySlots{{
+    {Element::kWood, 1},
+    {Element::kWood, 2},
+    {Element::kCopper, 1},
+    {Element::kTin, 1},
+    {Element::kIron, 1},
+    {Element::kStick, 1},
+    {Element::kStick, 2},
+    {Element::kBronzeBar, 1},
+    {Element::kBronzePick, 1},
+    {Element::kIronPick, 1},
+}};
+
+// Radii from the single agent cell to windows wider than any test board
+constexpr std::array<int, 5> kRadii{0, 1, 3, 7, 20};
+
+void check_egocentric(const CraftWorldGameState &state, const std::vector<float> &obs, int radius) {
+    const auto [rows, cols] = state.get_board_shape();
+    const auto full_obs = state.get_observation();
+    const auto full_channel_length = static_cast<std::size_t>((rows + 4) * (cols + 4));
+    const int side = (2 * radius) + 1;
+    const auto channel_length = static_cast<std::size_t>(side * side);
+    CHECK(obs.size() == kNumElements * channel_length);
+    const int top = (state.get_agent_index() / cols) - radius;
+    const int left = (state.get_agent_index() % cols) - radius;
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            const int board_r = top + r;
+            const int board_c = left + c;
+            const bool inside = board_r >= 0 && board_r < rows && board_c >= 0 && board_c < cols;
+            const auto idx = static_cast<std::size_t>((r * side) + c);
+            // The board sits inside the 2 cell border of the full observation
+            const auto full_idx = static_cast<std::size_t>(((board_r + 2) * (cols + 4)) + board_c + 2);
+            for (std::size_t channel = 0; channel < kNumElements; ++channel) {
+                const auto value = obs[(channel * channel_length) + idx];
+                if (inside) {
+                    CHECK(value == full_obs[(channel * full_channel_length) + full_idx]);
+                } else {
+                    CHECK(value == static_cast<float>(channel == static_cast<std::size_t>(Element::kWall)));
+                }
+            }
+        }
+    }
+}
+
+// Windows along walks, both one state at a time and stacked across boards of different sizes
+void test_egocentric_walks() {
+    std::mt19937 rng(0);
+    auto states = start_states();
+    for (auto &state : states) {
+        for (int i = 0; i < kWalkLength / 10 && !state.is_solution(); ++i) {
+            state.apply_action(walk_action(state, rng));
+            const int radius = kRadii[rng() % kRadii.size()];
+            check_egocentric(state, state.get_egocentric_observation(radius), radius);
+        }
+    }
+    std::vector<const CraftWorldGameState *> state_ptrs;
+    for (const auto &state : states) {
+        state_ptrs.push_back(&state);
+    }
+    for (const int radius : kRadii) {
+        const auto [c, h, w] = CraftWorldGameState::egocentric_observation_shape(radius);
+        const auto obs_size = static_cast<std::size_t>(c * h * w);
+        std::vector<float> obs(states.size() * obs_size, -1);
+        write_egocentric_observations(state_ptrs, obs, radius);
+        for (std::size_t i = 0; i < states.size(); ++i) {
+            const auto expected = states[i].get_egocentric_observation(radius);
+            const auto offset = static_cast<std::ptrdiff_t>(i * obs_size);
+            CHECK(std::equal(expected.begin(), expected.end(), obs.begin() + offset));
+        }
+    }
+}
+
+// Radius 0 shows only the agent's cell
+void test_radius_zero() {
+    const auto state = start_states()[0];
+    CHECK((CraftWorldGameState::egocentric_observation_shape(0) == std::array<int, 3>{kNumElements, 1, 1}));
+    const auto obs = state.get_egocentric_observation(0);
+    CHECK(obs.size() == kNumElements);
+    for (std::size_t channel = 0; channel < obs.size(); ++channel) {
+        CHECK(obs[channel] == static_cast<float>(channel == static_cast<std::size_t>(Element::kAgent)));
+    }
+    CHECK_THROWS((void)state.get_egocentric_observation(-1), std::invalid_argument);
+    std::vector<float> wrong_size(kNumElements * 4);
+    CHECK_THROWS(state.write_egocentric_observation(wrong_size, 0), std::invalid_argument);
+}
+
+// Each slot is filled at its count, and shows its element in the full observation border
+void test_inventory_observation() {
+    auto state = start_states()[0];
+    const auto [rows, cols] = state.get_board_shape();
+    const auto full_channel_length = static_cast<std::size_t>((rows + 4) * (cols + 4));
+    for (int count = 0; count <= 2; ++count) {
+        const auto obs = state.get_inventory_observation();
+        const auto full_obs = state.get_observation();
+        CHECK(obs.size() == kInventoryObservationSize);
+        for (std::size_t i = 0; i < kInventorySlots.size(); ++i) {
+            const auto &slot = kInventorySlots[i];
+            CHECK(obs[i] == static_cast<float>(count >= slot.min_count));
+            CHECK(obs[i] == full_obs[(static_cast<std::size_t>(slot.element) * full_channel_length) + i]);
+        }
+        for (const auto element : {Element::kWood, Element::kCopper, Element::kTin, Element::kIron, Element::kStick,
+                                   Element::kBronzeBar, Element::kBronzePick, Element::kIronPick}) {
+            state.add_to_inventory(element, 1);
+        }
+    }
+}
+
+}    // namespace
+
+int main() {
+    test_egocentric_walks();
+    test_radius_zero();
+    test_inventory_observation();
+    return finish("test_egocentric");
+}
@@ -0,0 +1,86 @@
+// test_fixed_size.cpp
+// CraftWorldGameStateT steps, masks, undoes and writes observations exactly as the dynamic state does
+
+#include <string>
+#include <variant>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+template <typename StateT>
+void check_walk(const CraftWorldGameState &start, std::mt19937 &rng) {
+    CraftWorldGameState state = start;
+    StateT fixed(start);
+    std::vector<float> obs(state.get_observation().size());
+    std::vector<float> fixed_obs(obs.size());
+    state.write_observation(obs);
+    fixed.write_observation(fixed_obs);
+    for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+        const auto action = walk_action(state, rng);
+        CHECK(fixed.effective_action_mask() == state.effective_action_mask());
+        // Undo every few actions, in step with the dynamic state
+        if (i % 5 == 0) {
+            const auto record = state.apply_action_with_undo(action);
+            const auto fixed_record = fixed.apply_action_with_undo(action);
+            state.undo(record);
+            fixed.undo(fixed_record);
+            state.update_observation(obs);
+            fixed.update_observation(fixed_obs);
+        }
+        state.apply_action(action);
+        fixed.apply_action(action);
+        state.update_observation(obs);
+        fixed.update_observation(fixed_obs);
+        CHECK(fixed == state);
+        CHECK(fixed.get_hash() == state.get_hash());
+        CHECK(fixed.get_hash128() == state.get_hash128());
+        CHECK(fixed.get_reward_signal() == state.get_reward_signal());
+        CHECK(fixed_obs == obs);
+        CHECK(fixed.get_observation() == state.get_observation());
+    }
+}
+
+void test_fixed_sizes() {
+    std::mt19937 rng(0);
+    for (const auto &start : start_states()) {
+        const auto [rows, cols] = start.get_board_shape();
+        if (rows == 10 && cols == 10) {
+            check_walk<CraftWorldGameStateT<10, 10>>(start, rng);
+        } else if (rows == 14 && cols == 14) {
+            check_walk<CraftWorldGameStateT<14, 14>>(start, rng);
+        } else if (rows == 18 && cols == 18) {
+            check_walk<CraftWorldGameStateT<18, 18>>(start, rng);
+        } else {
+            CHECK(!is_fixed_board_size(rows, cols));
+        }
+    }
+}
+
+// make_game_state() picks the specialization of each fixed size and falls back to the dynamic state
+void test_make_game_state() {
+    const auto check_kind = [](const std::string &board_str, std::size_t variant_idx) {
+        const auto any_state = make_game_state(board_str);
+        CHECK(any_state.index() == variant_idx);
+        std::visit([&](const auto &state) { CHECK(state == CraftWorldGameState(board_str)); }, any_state);
+    };
+    check_kind(generate_board_str({.map_size = 10}, 0), 1);
+    check_kind(load_problems("test_100")[0], 2);
+    check_kind(load_problems("test_100_hard")[0], 3);
+    check_kind(generate_board_str({.map_size = 12}, 0), 0);
+    // A specialization only holds boards of its own size
+    const auto board_str = load_problems("test_100")[0];
+    CHECK_THROWS((void)(CraftWorldGameStateT<10, 10>{board_str}), std::invalid_argument);
+    CHECK_THROWS((void)(CraftWorldGameStateT<18, 18>{CraftWorldGameState(board_str)}), std::invalid_argument);
+}
+
+}    // namespace
+
+int main() {
+    test_fixed_sizes();
+    test_make_game_state();
+    return finish("test_fixed_size");
+}
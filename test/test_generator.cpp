@@ -0,0 +1,71 @@
+// test_generator.cpp
+// Generated levels depend only on the options and seed, parse as boards, and are solvable when required
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+constexpr int kNumLevels = 20;
+
+auto option_sets() -> std::vector<GeneratorOptions> {
+    return {
+        {},
+        {.hard = true},
+        {.map_size = 14, .goal_probs = kGoalProbsTest, .num_primitive = 3, .num_grass = 5},
+        {.map_size = 8, .goal_probs = kGoalProbsTrainHard, .hard = true, .require_solvable = true},
+    };
+}
+
+void test_seeds() {
+    for (const auto &options : option_sets()) {
+        const auto board_strs = generate_board_strs(options, kNumLevels, 7, 1);
+        CHECK(board_strs.size() == kNumLevels);
+        CHECK(generate_board_strs(options, kNumLevels, 7, 4) == board_strs);
+        CHECK(generate_board_strs(options, kNumLevels, 8, 1) != board_strs);
+        for (std::size_t i = 0; i < board_strs.size(); ++i) {
+            CHECK(board_strs[i] == generate_board_str(options, 7 + i));
+            const CraftWorldGameState state(board_strs[i]);
+            CHECK(state.get_board_shape() == (std::array<int, 2>{options.map_size, options.map_size}));
+            CHECK(state.get_indices(Element::kAgent).size() == 1);
+            CHECK(!state.is_solution());
+        }
+    }
+    CHECK(generate_board_strs({}, 0, 0, 4).empty());
+}
+
+// Levels required to be solvable are solved by the solver
+void test_require_solvable() {
+    const GeneratorOptions options{.hard = true, .require_solvable = true};
+    const auto levels = generate_levels(options, kNumLevels, 0, 4);
+    for (const auto &result : solve_all(levels, {.algorithm = SearchAlgorithm::kAStar}, 4)) {
+        CHECK(result.status == SolverStatus::kSolved);
+    }
+}
+
+void test_bad_options() {
+    const std::vector<GeneratorOptions> bad_options{
+        {.map_size = 2},
+        {.map_size = kMaxBoardDim + 1},
+        {.goal_probs = {0.0, 0.0, 0.0}},
+        {.goal_probs = {0.5, -0.5, 1.0}},
+        {.num_primitive = -1},
+        {.num_grass = -1},
+    };
+    for (const auto &options : bad_options) {
+        CHECK_THROWS((void)generate_board_str(options, 0), std::invalid_argument);
+        CHECK_THROWS((void)generate_board_strs(options, kNumLevels, 0, 4), std::invalid_argument);
+    }
+    CHECK_THROWS((void)generate_board_strs({}, -1, 0), std::invalid_argument);
+}
+
+}    // namespace
+
+int main() {
+    test_seeds();
+    test_require_solvable();
+    test_bad_options();
+    return finish("test_generator");
+}
@@ -0,0 +1,103 @@
+// test_instrumentation.cpp
+// Instrumentation counts each event of a known action sequence, across threads and resets.
+// Only counts in builds with CRAFTWORLD_INSTRUMENTATION, otherwise every total stays zero.
+
+#include <thread>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+// 5x5 board with wood right of the agent and a workshop below it
+auto make_level() -> CraftWorldGameState {
+    std::vector<uint8_t> cells(25, static_cast<uint8_t>(Element::kEmpty));
+    cells[12] = static_cast<uint8_t>(Element::kAgent);
+    cells[13] = static_cast<uint8_t>(Element::kWood);
+    cells[17] = static_cast<uint8_t>(Element::kWorkshop1);
+    return {5, 5, Element::kStick, cells};
+}
+
+// Collect the wood, craft a stick, use the workshop without wood, walk into it, then walk around
+constexpr std::array<Action, 7> kActions{Action::kUse,   Action::kUse,  Action::kUse, Action::kDown,
+                                         Action::kRight, Action::kLeft, Action::kUp};
+
+auto counter(const InstrumentationSnapshot &snapshot, Counter c) -> uint64_t {
+    return snapshot.counters[static_cast<std::size_t>(c)];
+}
+
+void apply_actions() {
+    auto state = make_level();
+    for (const auto action : kActions) {
+        state.apply_action(action);
+    }
+    CHECK(state.get_agent_index() == 7);
+}
+
+void check_counts(const InstrumentationSnapshot &snapshot, uint64_t runs) {
+    CHECK(counter(snapshot, Counter::kActionUp) == runs);
+    CHECK(counter(snapshot, Counter::kActionRight) == runs);
+    CHECK(counter(snapshot, Counter::kActionDown) == runs);
+    CHECK(counter(snapshot, Counter::kActionLeft) == runs);
+    CHECK(counter(snapshot, Counter::kActionUse) == 3 * runs);
+    CHECK(counter(snapshot, Counter::kBlockedMoves) == runs);
+    CHECK(counter(snapshot, Counter::kNoOpUses) == runs);
+    CHECK(counter(snapshot, Counter::kCollects) == runs);
+    CHECK(counter(snapshot, Counter::kCrafts) == runs);
+    CHECK(counter(snapshot, Counter::kBridgeUses) == 0);
+    CHECK(counter(snapshot, Counter::kAxeUses) == 0);
+    CHECK((counter(snapshot, Counter::kHashUpdates) > 0) == (runs > 0));
+    CHECK(snapshot.timer_calls[static_cast<std::size_t>(Timer::kApplyAction)] == kActions.size() * runs);
+}
+
+void check_zero(const InstrumentationSnapshot &snapshot) {
+    for (const auto value : snapshot.counters) {
+        CHECK(value == 0);
+    }
+    for (const auto value : snapshot.timer_calls) {
+        CHECK(value == 0);
+    }
+}
+
+void test_counts() {
+    reset_instrumentation();
+    apply_actions();
+    check_counts(get_instrumentation(), 1);
+    apply_actions();
+    check_counts(get_instrumentation(), 2);
+    reset_instrumentation();
+    check_zero(get_instrumentation());
+}
+
+// Counts of threads which have exited stay in the totals until a reset
+void test_exited_threads() {
+    reset_instrumentation();
+    std::thread(apply_actions).join();
+    check_counts(get_instrumentation(), 1);
+    apply_actions();
+    std::thread(apply_actions).join();
+    check_counts(get_instrumentation(), 3);
+    reset_instrumentation();
+    check_zero(get_instrumentation());
+    std::thread(apply_actions).join();
+    check_counts(get_instrumentation(), 1);
+}
+
+void test_disabled() {
+    apply_actions();
+    check_zero(get_instrumentation());
+}
+
+}    // namespace
+
+int main() {
+    if constexpr (kInstrumentation) {
+        test_counts();
+        test_exited_threads();
+    } else {
+        test_disabled();
+    }
+    return finish("test_instrumentation");
+}
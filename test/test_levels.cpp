@@ -0,0 +1,136 @@
+// test_levels.cpp
+// Problem files load to the same levels as parsing each line, with any number of threads,
+// and level packs read back the levels written to them
+
+#include <array>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+void test_load_levels() {
+    for (const auto &level_set : {"test_100", "test_100_hard"}) {
+        const auto board_strs = load_problems(level_set);
+        const std::string path = std::string(CRAFTWORLD_PROBLEMS_DIR) + "/" + level_set + ".txt";
+        for (const int num_threads : {1, 4}) {
+            const auto levels = load_levels(path, num_threads);
+            CHECK(levels.size() == board_strs.size());
+            for (std::size_t i = 0; i < levels.size() && i < board_strs.size(); ++i) {
+                const CraftWorldGameState expected(board_strs[i]);
+                CHECK(levels[i] == expected);
+                CHECK(levels[i].get_hash() == expected.get_hash());
+            }
+        }
+    }
+}
+
+// Blank lines are skipped, and an invalid board is reported rather than loaded
+void test_load_levels_errors() {
+    const auto board_strs = load_problems("test_100");
+    const auto path = temp_path("test_levels.txt");
+    {
+        std::ofstream file(path);
+        file << board_strs[0] << "\n\n" << board_strs[1] << "\n";
+    }
+    CHECK(load_levels(path).size() == 2);
+    {
+        std::ofstream file(path);
+        file << board_strs[0] << "\n" << board_strs[1].substr(0, board_strs[1].size() / 2) << "\n";
+    }
+    CHECK_THROWS((void)load_levels(path, 2), std::invalid_argument);
+    CHECK_THROWS((void)load_levels(temp_path("missing_levels.txt")), std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+void test_level_pack() {
+    const auto path = temp_path("test_levels.cwlp");
+    for (const auto &level_set : {"test_100", "test_100_hard"}) {
+        const auto levels = load_levels(std::string(CRAFTWORLD_PROBLEMS_DIR) + "/" + level_set + ".txt");
+        write_level_pack(path, levels);
+        const LevelPack pack(path);
+        CHECK(pack.size() == levels.size());
+        // Read out of order, as random access does
+        for (std::size_t i = 0; i < pack.size() && i < levels.size(); ++i) {
+            const auto level_idx = (i * 7) % levels.size();
+            const auto level = pack.get(level_idx);
+            CHECK(level == levels[level_idx]);
+            CHECK(level.get_hash() == levels[level_idx].get_hash());
+        }
+        CHECK_THROWS((void)pack.get(levels.size()), std::invalid_argument);
+    }
+    std::filesystem::remove(path);
+}
+
+// Levels with an inventory cannot be packed, since records only store the board
+void test_level_pack_inventory() {
+    const CraftWorldGameState level(load_problems("test_100")[0]);
+    auto stocked = level;
+    stocked.add_to_inventory(Element::kWood, 1);
+    const auto path = temp_path("test_levels_inventory.cwlp");
+    LevelPackWriter writer(path);
+    CHECK_THROWS(writer.add(stocked), std::invalid_argument);
+    writer.add(level);
+    writer.finish();
+    CHECK_THROWS(writer.add(level), std::invalid_argument);
+    CHECK(LevelPack(path).size() == 1);
+    std::filesystem::remove(path);
+}
+
+// Every truncation of a pack is rejected when opened, rather than read past the end
+void test_truncated_level_pack() {
+    const auto board_strs = load_problems("test_100");
+    const auto path = temp_path("test_levels.cwlp");
+    const auto truncated_path = temp_path("test_levels_truncated.cwlp");
+    write_level_pack(path, {CraftWorldGameState(board_strs[0]), CraftWorldGameState(board_strs[1])});
+    std::vector<char> contents;
+    {
+        std::ifstream file(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    for (std::size_t size = 0; size < contents.size(); ++size) {
+        {
+            std::ofstream file(truncated_path, std::ios::binary | std::ios::trunc);
+            file.write(contents.data(), static_cast<std::streamsize>(size));
+        }
+        CHECK_THROWS(LevelPack{truncated_path}, std::invalid_argument);
+    }
+    CHECK_THROWS(LevelPack{temp_path("missing_levels.cwlp")}, std::invalid_argument);
+    // Index entries pointing outside the records, including offsets which wrap around when added to.
+    // The 24 byte header is followed by the two records of equal size, then the 8 byte index entries.
+    const std::size_t index_offset = contents.size() - 16;
+    const std::size_t second_record = 24 + ((index_offset - 24) / 2);
+    constexpr uint64_t kMaxOffset = std::numeric_limits<uint64_t>::max();
+    const std::array<uint64_t, 5> bad_offsets{0, kMaxOffset, kMaxOffset - 2, index_offset - 2, second_record + 1};
+    for (const auto bad_offset : bad_offsets) {
+        auto corrupt = contents;
+        for (std::size_t byte = 0; byte < 8; ++byte) {
+            corrupt[index_offset + byte] = static_cast<char>((bad_offset >> (8 * byte)) & 0xFFU);
+        }
+        {
+            std::ofstream file(truncated_path, std::ios::binary | std::ios::trunc);
+            file.write(corrupt.data(), static_cast<std::streamsize>(corrupt.size()));
+        }
+        const LevelPack pack(truncated_path);
+        CHECK_THROWS((void)pack.get(0), std::invalid_argument);
+        CHECK(pack.get(1) == CraftWorldGameState(board_strs[1]));
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(truncated_path);
+}
+
+}    // namespace
+
+int main() {
+    test_load_levels();
+    test_load_levels_errors();
+    test_level_pack();
+    test_level_pack_inventory();
+    test_truncated_level_pack();
+    return finish("test_levels");
+}
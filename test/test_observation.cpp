@@ -0,0 +1,57 @@
+// test_observation.cpp
+// Observations patched by update_observation() after each action match ones written from scratch,
+// and the uint8 and bit-packed formats hold the same values
+
+#include <algorithm>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+void test_update_observation() {
+    std::mt19937 rng(0);
+    for (auto state : start_states()) {
+        std::vector<float> patched(state.get_observation().size());
+        std::vector<float> written(patched.size());
+        state.write_observation(patched);
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            state.apply_action(walk_action(state, rng));
+            state.update_observation(patched);
+            state.write_observation(written);
+            CHECK(patched == written);
+            CHECK(written == state.get_observation());
+        }
+    }
+}
+
+void test_compact_observations() {
+    std::mt19937 rng(0);
+    for (auto state : start_states()) {
+        const auto size = state.get_observation().size();
+        std::vector<uint8_t> obs_uint8(size);
+        std::vector<uint8_t> packed(static_cast<std::size_t>(state.packed_observation_size()));
+        std::vector<float> unpacked(size);
+        CHECK(packed.size() == (size + 7) / 8);
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            state.apply_action(walk_action(state, rng));
+            const auto obs = state.get_observation();
+            state.write_observation_uint8(obs_uint8);
+            CHECK(std::equal(obs.begin(), obs.end(), obs_uint8.begin(),
+                             [](float a, uint8_t b) { return a == static_cast<float>(b); }));
+            state.write_observation_packed(packed);
+            unpack_observation(packed, unpacked);
+            CHECK(unpacked == obs);
+        }
+    }
+}
+
+}    // namespace
+
+int main() {
+    test_update_observation();
+    test_compact_observations();
+    return finish("test_observation");
+}
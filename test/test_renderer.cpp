@@ -0,0 +1,93 @@
+// test_renderer.cpp
+// CraftWorldRenderer frames match to_image() along walks at every tile size, across boards of other sizes and
+// resets, and smaller tiles average the full sprites
+
+#include <algorithm>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+// Steps rendered per start state, fewer than other walks as each compares a full image
+constexpr int kRenderSteps = kWalkLength / 10;
+
+void check_frame(CraftWorldRenderer &renderer, const CraftWorldGameState &state, int tile_size) {
+    const auto frame = renderer.render(state);
+    const auto expected = state.to_image(tile_size);
+    CHECK(renderer.image_shape() == state.image_shape(tile_size));
+    CHECK(std::equal(frame.begin(), frame.end(), expected.begin(), expected.end()));
+}
+
+// start_states() goes from 10x10 to 14x14 to 18x18 boards, so one renderer also switches board sizes
+void test_render_walks() {
+    const auto states = start_states();
+    for (const int tile_size : kTileSizes) {
+        std::mt19937 rng(0);
+        CraftWorldRenderer renderer(tile_size);
+        CHECK(renderer.tile_size() == tile_size);
+        for (std::size_t i = 0; i < states.size(); ++i) {
+            auto state = states[i];
+            if (i % 5 == 4) {
+                renderer.reset();
+            }
+            check_frame(renderer, state, tile_size);
+            for (int step = 0; step < kRenderSteps && !state.is_solution(); ++step) {
+                state.apply_action(walk_action(state, rng));
+                check_frame(renderer, state, tile_size);
+            }
+            // Back to the first board, which is smaller than the later ones
+            check_frame(renderer, states.front(), tile_size);
+        }
+    }
+}
+
+void test_tile_sizes() {
+    const auto state = start_states().back();
+    for (const int tile_size : kTileSizes) {
+        const auto [h, w, c] = state.image_shape(tile_size);
+        CHECK(h == (state.get_board_shape()[0] + 4) * tile_size && c == SPRITE_CHANNELS);
+        CHECK(state.to_image(tile_size).size() == static_cast<std::size_t>(h * w * c));
+    }
+    // A 1 pixel tile is the rounded mean of the full sprite
+    const auto full_atlas = sprite_atlas(SPRITE_WIDTH);
+    const auto pixel_atlas = sprite_atlas(1);
+    constexpr int kSpritePixels = SPRITE_WIDTH * SPRITE_HEIGHT;
+    for (const auto element : {Element::kAgent, Element::kWall, Element::kWater, Element::kGold, Element::kGemRing}) {
+        const auto tile = static_cast<std::size_t>(element);
+        for (int ch = 0; ch < SPRITE_CHANNELS; ++ch) {
+            int sum = 0;
+            for (int pixel = 0; pixel < kSpritePixels; ++pixel) {
+                sum += full_atlas[(tile * SPRITE_DATA_LEN) + static_cast<std::size_t>(pixel * SPRITE_CHANNELS + ch)];
+            }
+            const auto mean = static_cast<uint8_t>((sum + kSpritePixels / 2) / kSpritePixels);
+            CHECK(pixel_atlas[(tile * SPRITE_CHANNELS) + static_cast<std::size_t>(ch)] == mean);
+        }
+    }
+    // The agent's pixel of a 1 pixel image, inside the 2 tile border
+    const auto img = state.to_image(1);
+    const auto cols = state.get_board_shape()[1];
+    const auto agent_pixel = static_cast<std::size_t>(((state.get_agent_index() / cols + 2) * (cols + 4)) +
+                                                      (state.get_agent_index() % cols + 2));
+    const auto agent_tile = static_cast<std::size_t>(Element::kAgent);
+    for (std::size_t ch = 0; ch < SPRITE_CHANNELS; ++ch) {
+        CHECK(img[(agent_pixel * SPRITE_CHANNELS) + ch] == pixel_atlas[(agent_tile * SPRITE_CHANNELS) + ch]);
+    }
+    // Unsupported sizes
+    const auto [bad_h, bad_w, bad_c] = state.image_shape(3);
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(bad_h * bad_w * bad_c));
+    CHECK_THROWS((void)state.to_image(3), std::invalid_argument);
+    CHECK_THROWS(state.write_image(buffer, 3), std::invalid_argument);
+    CHECK_THROWS(CraftWorldRenderer{3}, std::invalid_argument);
+    CHECK_THROWS((void)sprite_atlas(3), std::invalid_argument);
+}
+
+}    // namespace
+
+int main() {
+    test_render_walks();
+    test_tile_sizes();
+    return finish("test_renderer");
+}
@@ -0,0 +1,70 @@
+// test_rollout.cpp
+// RolloutEngine statistics depend only on the options, not on the number of threads
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+void check_same(const RolloutStats &stats, const RolloutStats &expected) {
+    CHECK(stats.num_rollouts == expected.num_rollouts);
+    CHECK(stats.num_solved == expected.num_solved);
+    CHECK(stats.total_steps == expected.total_steps);
+    CHECK(stats.solved_fraction == expected.solved_fraction);
+    CHECK(stats.mean_steps_to_solve == expected.mean_steps_to_solve);
+    CHECK(stats.reward_bit_counts == expected.reward_bit_counts);
+    CHECK(stats.reward_bit_frequencies == expected.reward_bit_frequencies);
+}
+
+// Prefers use, which only depends on the state and the rollout's own RNG, so it is thread safe
+auto prefer_use(const CraftWorldGameState &state, std::mt19937_64 &rng) -> Action {
+    if ((state.effective_action_mask() & (1U << static_cast<unsigned>(Action::kUse))) != 0) {
+        return Action::kUse;
+    }
+    return static_cast<Action>(rng() % kNumActions);
+}
+
+void test_thread_counts() {
+    const auto states = start_states();
+    RolloutEngine single_thread(1);
+    RolloutEngine two_threads(2);
+    RolloutEngine four_threads(4);
+    for (std::size_t i = 0; i < states.size(); i += 7) {
+        for (const auto policy : {RolloutPolicy::kUniform, RolloutPolicy::kMaskedUniform, RolloutPolicy::kCallback}) {
+            const RolloutOptions options{
+                .num_rollouts = 200,
+                .max_depth = 100,
+                .policy = policy,
+                .callback = prefer_use,
+                .seed = i,
+            };
+            const auto expected = single_thread.run(states[i], options);
+            CHECK(expected.num_rollouts == options.num_rollouts);
+            for (auto *engine : {&two_threads, &four_threads}) {
+                check_same(engine->run(states[i], options), expected);
+            }
+        }
+    }
+}
+
+// The same seed repeats a run, and another seed gives other rollouts
+void test_seeds() {
+    const auto state = start_states().back();
+    RolloutEngine engine(2);
+    RolloutOptions options{.num_rollouts = 500, .max_depth = 100, .policy = RolloutPolicy::kMaskedUniform};
+    const auto first = engine.run(state, options);
+    check_same(engine.run(state, options), first);
+    options.seed = 1;
+    const auto other = engine.run(state, options);
+    CHECK(other.total_steps != first.total_steps || other.reward_bit_counts != first.reward_bit_counts);
+}
+
+}    // namespace
+
+int main() {
+    test_thread_counts();
+    test_seeds();
+    return finish("test_rollout");
+}
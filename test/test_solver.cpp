@@ -0,0 +1,109 @@
+// test_solver.cpp
+// The solvers find optimal plans which reach the goal, and report limits and errors
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+// Levels solved by both algorithms, the bundled 18x18 levels taking seconds each to solve
+constexpr int kSolvedLevelsPerSet = 10;
+constexpr int kSolvedHardLevels = 3;
+
+auto solver_levels() -> std::vector<CraftWorldGameState> {
+    std::vector<CraftWorldGameState> levels = generate_levels({.hard = true}, kSolvedLevelsPerSet, 0);
+    const auto board_strs = load_problems("test_100");
+    const auto hard_board_strs = load_problems("test_100_hard");
+    for (int i = 0; i < kSolvedLevelsPerSet; ++i) {
+        levels.emplace_back(board_strs[static_cast<std::size_t>(i)]);
+    }
+    for (int i = 0; i < kSolvedHardLevels; ++i) {
+        levels.emplace_back(hard_board_strs[static_cast<std::size_t>(i)]);
+    }
+    return levels;
+}
+
+// Replaying the plan reaches the goal, and only at its last action
+void check_plan(const CraftWorldGameState &level, const SolverResult &result) {
+    CHECK(result.status == SolverStatus::kSolved);
+    CHECK(result.expanded > 0 && result.generated > 0);
+    auto state = level;
+    for (const auto action : result.actions) {
+        CHECK(!state.is_solution());
+        state.apply_action(action);
+    }
+    CHECK(state.is_solution());
+}
+
+// BFS and A* both find optimal plans, so their plans have the same length
+void test_bfs_matches_astar() {
+    const auto levels = solver_levels();
+    const auto bfs_results = solve_all(levels, {.algorithm = SearchAlgorithm::kBFS}, 4);
+    const auto astar_results = solve_all(levels, {.algorithm = SearchAlgorithm::kAStar}, 4);
+    CHECK(bfs_results.size() == levels.size() && astar_results.size() == levels.size());
+    for (std::size_t i = 0; i < levels.size() && i < bfs_results.size() && i < astar_results.size(); ++i) {
+        check_plan(levels[i], bfs_results[i]);
+        check_plan(levels[i], astar_results[i]);
+        CHECK(bfs_results[i].actions.size() == astar_results[i].actions.size());
+        // solve_all gives each level the result solve() would
+        CHECK(solve(levels[i], {.algorithm = SearchAlgorithm::kAStar}).actions == astar_results[i].actions);
+    }
+}
+
+// A level which is already solved needs no actions
+void test_solved_level() {
+    auto level = solver_levels()[0];
+    level.add_to_inventory(level.get_goal(), 1);
+    for (const auto algorithm : {SearchAlgorithm::kBFS, SearchAlgorithm::kAStar}) {
+        const auto result = solve(level, {.algorithm = algorithm});
+        CHECK(result.status == SolverStatus::kSolved);
+        CHECK(result.actions.empty());
+    }
+}
+
+void test_expansion_limit() {
+    const auto level = solver_levels()[kSolvedLevelsPerSet];
+    for (const auto algorithm : {SearchAlgorithm::kBFS, SearchAlgorithm::kAStar}) {
+        const auto result = solve(level, {.algorithm = algorithm, .max_expansions = 10});
+        CHECK(result.status == SolverStatus::kLimitReached);
+        CHECK(result.actions.empty());
+        CHECK(result.expanded <= 10);
+    }
+}
+
+// A gem ring needs a gem, so a board without one cannot be solved
+void test_unsolvable_level() {
+    std::vector<uint8_t> cells(25, static_cast<uint8_t>(Element::kEmpty));
+    cells[12] = static_cast<uint8_t>(Element::kAgent);
+    cells[0] = static_cast<uint8_t>(Element::kWood);
+    cells[4] = static_cast<uint8_t>(Element::kWorkshop1);
+    const CraftWorldGameState level(5, 5, Element::kGemRing, cells);
+    for (const auto algorithm : {SearchAlgorithm::kBFS, SearchAlgorithm::kAStar}) {
+        const auto result = solve(level, {.algorithm = algorithm});
+        CHECK(result.status == SolverStatus::kUnsolvable);
+        CHECK(result.actions.empty());
+    }
+}
+
+// Errors inside the thread pool come back to the caller as exceptions, rather than terminating
+void test_solve_all_errors() {
+    const std::vector<CraftWorldGameState> levels(8, CraftWorldGameState(load_problems("test_100")[0]));
+    const SolverOptions options{.algorithm = static_cast<SearchAlgorithm>(7)};
+    CHECK_THROWS((void)solve(levels[0], options), std::invalid_argument);
+    for (const int num_threads : {1, 4}) {
+        CHECK_THROWS((void)solve_all(levels, options, num_threads), std::invalid_argument);
+    }
+}
+
+}    // namespace
+
+int main() {
+    test_bfs_matches_astar();
+    test_solved_level();
+    test_expansion_limit();
+    test_unsolvable_level();
+    test_solve_all_errors();
+    return finish("test_solver");
+}
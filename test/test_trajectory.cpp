@@ -0,0 +1,128 @@
+// test_trajectory.cpp
+// Recorded trajectories replay to the states of the episode, and truncated files are rejected or cut
+// back to their complete chunks
+
+#include <algorithm>
+#include <iterator>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+// Few actions between checkpoints, so walks span many chunks
+constexpr int kCheckpointInterval = 7;
+
+struct Episode {
+    std::vector<CraftWorldGameState> states;    // State at each step, the initial state first
+    std::vector<Action> actions;
+};
+
+auto record(const std::string &path, const CraftWorldGameState &start, std::mt19937 &rng) -> Episode {
+    Episode episode{.states = {start}, .actions = {}};
+    TrajectoryRecorder recorder(path, start, kCheckpointInterval);
+    auto state = start;
+    for (int i = 0; i < kWalkLength / 4 && !state.is_solution(); ++i) {
+        const auto action = walk_action(state, rng);
+        state.apply_action(action);
+        recorder.record(action);
+        episode.states.push_back(state);
+        episode.actions.push_back(action);
+    }
+    CHECK(recorder.num_steps() == episode.actions.size());
+    CHECK(recorder.state() == state);
+    recorder.finish();
+    return episode;
+}
+
+void check_state(const CraftWorldGameState &replayed, const CraftWorldGameState &state) {
+    CHECK(replayed == state);
+    CHECK(replayed.get_hash() == state.get_hash());
+    CHECK(replayed.get_reward_signal() == state.get_reward_signal());
+}
+
+void test_replay() {
+    std::mt19937 rng(0);
+    const auto path = temp_path("test_trajectory.cwtr");
+    for (const auto &start : start_states()) {
+        const auto episode = record(path, start, rng);
+        TrajectoryReplayer replayer(path);
+        CHECK(replayer.num_steps() == episode.actions.size());
+        CHECK(replayer.checkpoint_interval() == kCheckpointInterval);
+        CHECK(std::equal(replayer.actions().begin(), replayer.actions().end(), episode.actions.begin(),
+                         episode.actions.end()));
+        // Step through in order
+        check_state(replayer.state(), episode.states[0]);
+        for (std::size_t step = 1; step < episode.states.size(); ++step) {
+            CHECK(replayer.step());
+            CHECK(replayer.current_step() == step);
+            check_state(replayer.state(), episode.states[step]);
+        }
+        CHECK(!replayer.step());
+        // Seek back and forth, within and across chunks
+        for (int i = 0; i < 20; ++i) {
+            const auto step = static_cast<std::size_t>(rng() % episode.states.size());
+            replayer.seek(step);
+            CHECK(replayer.current_step() == step);
+            check_state(replayer.state(), episode.states[step]);
+        }
+        CHECK_THROWS(replayer.seek(episode.states.size()), std::invalid_argument);
+        // Stacked observations of a range of steps
+        const auto begin = episode.states.size() / 3;
+        const auto end = episode.states.size();
+        const auto obs_size = episode.states[0].get_observation().size();
+        std::vector<float> obs((end - begin) * obs_size);
+        replayer.write_observations(begin, end, obs);
+        for (auto step = begin; step < end; ++step) {
+            const auto expected = episode.states[step].get_observation();
+            const auto offset = static_cast<std::ptrdiff_t>((step - begin) * obs_size);
+            CHECK(std::equal(expected.begin(), expected.end(), obs.begin() + offset));
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+// A file cut short, as by a crash while recording, either fails to open or replays its complete chunks
+void test_truncated() {
+    std::mt19937 rng(0);
+    const auto path = temp_path("test_trajectory.cwtr");
+    const auto truncated_path = temp_path("test_trajectory_truncated.cwtr");
+    const auto episode = record(path, start_states().back(), rng);
+    std::vector<char> contents;
+    {
+        std::ifstream file(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::size_t num_opened = 0;
+    for (std::size_t size = 0; size < contents.size(); ++size) {
+        {
+            std::ofstream file(truncated_path, std::ios::binary | std::ios::trunc);
+            file.write(contents.data(), static_cast<std::streamsize>(size));
+        }
+        try {
+            TrajectoryReplayer replayer(truncated_path);
+            ++num_opened;
+            CHECK(replayer.num_steps() % kCheckpointInterval == 0);
+            CHECK(replayer.num_steps() < episode.actions.size());
+            replayer.seek(replayer.num_steps());
+            check_state(replayer.state(), episode.states[replayer.num_steps()]);
+        } catch (const std::invalid_argument &) {
+            // Only files without a complete first chunk are rejected
+            CHECK(num_opened == 0);
+        }
+    }
+    CHECK(num_opened > 0);
+    CHECK_THROWS(TrajectoryReplayer{temp_path("missing_trajectory.cwtr")}, std::invalid_argument);
+    std::filesystem::remove(path);
+    std::filesystem::remove(truncated_path);
+}
+
+}    // namespace
+
+int main() {
+    test_replay();
+    test_truncated();
+    return finish("test_trajectory");
+}
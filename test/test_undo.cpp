@@ -0,0 +1,88 @@
+// test_undo.cpp
+// Undoing actions restores the exact state from before them, including the hashes and reward signal
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+// State value along with the parts which operator== leaves out
+struct Snapshot {
+    CraftWorldGameState state;
+    uint64_t hash;
+    Hash128 hash128;
+    uint64_t reward_signal;
+    std::vector<float> obs;
+
+    explicit Snapshot(const CraftWorldGameState &_state)
+        : state(_state),
+          hash(_state.get_hash()),
+          hash128(_state.get_hash128()),
+          reward_signal(_state.get_reward_signal()),
+          obs(_state.get_observation()) {}
+};
+
+void check_restored(const CraftWorldGameState &state, const Snapshot &snapshot) {
+    CHECK(state == snapshot.state);
+    CHECK(state.get_hash() == snapshot.hash);
+    CHECK(state.get_hash128() == snapshot.hash128);
+    CHECK(state.get_reward_signal() == snapshot.reward_signal);
+    CHECK(state.get_agent_index() == snapshot.state.get_agent_index());
+}
+
+// Apply and undo actions at random, checking every undo restores the state before its action
+void test_undo() {
+    std::mt19937 rng(0);
+    for (auto state : start_states()) {
+        std::vector<Snapshot> snapshots;
+        std::vector<CraftWorldGameState::UndoRecord> records;
+        std::vector<float> obs = state.get_observation();
+        for (int i = 0; i < kWalkLength; ++i) {
+            if (!records.empty() && (state.is_solution() || rng() % 3 == 0)) {
+                state.undo(records.back());
+                state.update_observation(obs);
+                check_restored(state, snapshots.back());
+                CHECK(obs == snapshots.back().obs);
+                records.pop_back();
+                snapshots.pop_back();
+            } else if (!state.is_solution()) {
+                snapshots.emplace_back(state);
+                records.push_back(state.apply_action_with_undo(walk_action(state, rng)));
+                state.update_observation(obs);
+            }
+        }
+        // Unwind the rest back to the start state
+        while (!records.empty()) {
+            state.undo(records.back());
+            check_restored(state, snapshots.back());
+            records.pop_back();
+            snapshots.pop_back();
+        }
+    }
+}
+
+// Stepping with and without undo records gives the same states
+void test_apply_with_undo_matches_apply() {
+    std::mt19937 rng(0);
+    for (auto state : start_states()) {
+        auto with_undo = state;
+        for (int i = 0; i < kWalkLength && !state.is_solution(); ++i) {
+            const auto action = walk_action(state, rng);
+            state.apply_action(action);
+            (void)with_undo.apply_action_with_undo(action);
+            CHECK(with_undo == state);
+            CHECK(with_undo.get_hash() == state.get_hash());
+            CHECK(with_undo.get_reward_signal() == state.get_reward_signal());
+        }
+    }
+}
+
+}    // namespace
+
+int main() {
+    test_undo();
+    test_apply_with_undo_matches_apply();
+    return finish("test_undo");
+}
@@ -0,0 +1,131 @@
+// test_util.h
+// Helpers shared by the unit tests: a CHECK that counts failures, and the states the tests walk from
+
+#ifndef CRAFTWORLD_TEST_UTIL_H_
+#define CRAFTWORLD_TEST_UTIL_H_
+
+#include <craftworld/craftworld.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef CRAFTWORLD_PROBLEMS_DIR
+#define CRAFTWORLD_PROBLEMS_DIR "problems"
+#endif
+
+// Report a failed condition and keep going, so one run shows every failure
+#define CHECK(cond)                                                                                 \
+    do {                                                                                            \
+        if (!(cond)) {                                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl;   \
+            ++craftworld::test::num_failures;                                                       \
+        }                                                                                           \
+    } while (false)
+
+// Check that the statement throws the exception type
+#define CHECK_THROWS(statement, exception)   \
+    do {                                     \
+        bool thrown = false;                 \
+        try {                                \
+            statement;                       \
+        } catch (const exception &) {        \
+            thrown = true;                   \
+        }                                    \
+        CHECK(thrown && #statement);         \
+    } while (false)
+
+namespace craftworld::test {
+
+inline int num_failures = 0;
+
+// Levels taken from each set, enough to cover every goal without slowing the tests down
+constexpr int kLevelsPerSet = 10;
+
+// Actions taken by each walk
+constexpr int kWalkLength = 500;
+
+inline auto load_problems(const std::string &level_set) -> std::vector<std::string> {
+    const std::string path = std::string(CRAFTWORLD_PROBLEMS_DIR) + "/" + level_set + ".txt";
+    std::ifstream file(path);
+    if (!file) {
+        throw std::invalid_argument("Unable to open " + path);
+    }
+    std::vector<std::string> board_strs;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            board_strs.push_back(line);
+        }
+    }
+    return board_strs;
+}
+
+// Path for a file written by a test, in the system temp directory
+inline auto temp_path(const std::string &name) -> std::string {
+    return (std::filesystem::temp_directory_path() / ("craftworld_" + name)).string();
+}
+
+/**
+ * Get the states the tests start from: 10x10 generated levels and the 14x14 and 18x18 bundled levels, each
+ * also as a copy holding every item other than the goal, so walks from it craft, mine and cross water.
+ * @return Start states
+ */
+inline auto start_states() -> std::vector<CraftWorldGameState> {
+    std::vector<CraftWorldGameState> states = generate_levels({.hard = true}, kLevelsPerSet, 0);
+    for (const auto &level_set : {"test_100", "test_100_hard"}) {
+        const auto board_strs = load_problems(level_set);
+        for (int i = 0; i < kLevelsPerSet; ++i) {
+            states.emplace_back(board_strs[static_cast<std::size_t>(i)]);
+        }
+    }
+    const auto num_levels = states.size();
+    for (std::size_t i = 0; i < num_levels; ++i) {
+        auto stocked = states[i];
+        for (int element = kPrimitiveStart; element < kNumElements - 1; ++element) {
+            if (static_cast<Element>(element) != stocked.get_goal()) {
+                stocked.add_to_inventory(static_cast<Element>(element), element < kRecipeStart ? 3 : 1);
+            }
+        }
+        states.push_back(std::move(stocked));
+    }
+    return states;
+}
+
+/**
+ * Pick the next action of a random walk, mostly one which changes the state so walks collect, craft and mine.
+ * @param state State to act in
+ * @param rng Random generator of the walk
+ * @return Action to apply
+ */
+inline auto walk_action(const CraftWorldGameState &state, std::mt19937 &rng) -> Action {
+    const uint8_t mask = state.effective_action_mask();
+    if (mask != 0 && rng() % 4 != 0) {
+        while (true) {
+            const auto action = static_cast<int>(rng() % kNumActions);
+            if ((mask & (1U << static_cast<unsigned>(action))) != 0) {
+                return static_cast<Action>(action);
+            }
+        }
+    }
+    return static_cast<Action>(rng() % kNumActions);
+}
+
+// Print the outcome of a test executable and get its exit code
+inline auto finish(const std::string &name) -> int {
+    if (num_failures > 0) {
+        std::cerr << name << ": " << num_failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << name << ": passed" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+}    // namespace craftworld::test
+
+#endif    // CRAFTWORLD_TEST_UTIL_H_
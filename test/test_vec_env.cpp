@@ -0,0 +1,152 @@
+// test_vec_env.cpp
+// CraftWorldVecEnv writes what stepping each state on its own gives, across auto-resets and thread counts
+
+#include <algorithm>
+
+#include "test_util.h"
+
+using namespace craftworld;
+using namespace craftworld::test;
+
+namespace {
+
+constexpr int kNumEnvs = 8;
+constexpr int kNumSteps = 300;
+
+// The bundled levels of start_states(), as the environments load levels from board strings.
+// The 18x18 levels take seconds each to solve, so their environments only walk.
+struct LevelSet {
+    std::vector<std::string> board_strs;
+    bool follow_plans;
+};
+
+auto level_sets() -> std::vector<LevelSet> {
+    std::vector<LevelSet> sets{{generate_board_strs({.hard = true}, kLevelsPerSet, 0), true}};
+    for (const auto &[level_set, follow_plans] : {std::pair{"test_100", true}, std::pair{"test_100_hard", false}}) {
+        auto board_strs = load_problems(level_set);
+        board_strs.resize(kLevelsPerSet);
+        sets.push_back({std::move(board_strs), follow_plans});
+    }
+    return sets;
+}
+
+// Index of the level the state starts, which must be one of them
+auto level_index(const std::vector<CraftWorldGameState> &levels, const CraftWorldGameState &state) -> std::size_t {
+    const auto index = static_cast<std::size_t>(std::find(levels.begin(), levels.end(), state) - levels.begin());
+    CHECK(index < levels.size());
+    return std::min(index, levels.size() - 1);
+}
+
+// The outputs of the environment for each state, as stepping that state on its own gives them
+void check_outputs(const CraftWorldVecEnv &env, const std::vector<CraftWorldGameState> &states) {
+    const auto obs = env.observations();
+    const auto obs_size = obs.size() / states.size();
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        CHECK(env.get_state(static_cast<int>(i)) == states[i]);
+        const auto expected = states[i].get_observation();
+        CHECK(expected.size() == obs_size);
+        CHECK(std::equal(expected.begin(), expected.end(), obs.begin() + static_cast<std::ptrdiff_t>(i * obs_size)));
+        CHECK(env.action_masks()[i] == states[i].effective_action_mask());
+    }
+}
+
+/**
+ * Step the environments beside copies of their states, even environments following the optimal plan of their
+ * level so their episodes end, and odd ones walking.
+ * @return Level each environment was reset to, in order, to compare runs on other thread counts
+ */
+auto run(const LevelSet &level_set, const std::vector<SolverResult> &plans, int num_threads) -> std::vector<int> {
+    std::vector<CraftWorldGameState> levels;
+    for (const auto &board_str : level_set.board_strs) {
+        levels.emplace_back(board_str);
+    }
+    CraftWorldVecEnv env(level_set.board_strs, kNumEnvs, num_threads, 0);
+    CHECK(env.num_envs() == kNumEnvs);
+    CHECK(env.observation_shape() == levels[0].observation_shape());
+    std::mt19937 rng(0);
+    std::vector<int> resets;
+    std::vector<CraftWorldGameState> states;
+    std::vector<std::size_t> plan_levels(kNumEnvs);
+    std::vector<std::size_t> plan_steps(kNumEnvs);
+    const auto reset_env = [&](std::size_t i) {
+        const auto &state = env.get_state(static_cast<int>(i));
+        plan_levels[i] = level_index(levels, state);
+        plan_steps[i] = 0;
+        resets.push_back(static_cast<int>(plan_levels[i]));
+        return state;
+    };
+    const auto reset_all = [&]() {
+        states.clear();
+        for (std::size_t i = 0; i < kNumEnvs; ++i) {
+            states.push_back(reset_env(i));
+            CHECK(env.reward_signals()[i] == 0 && env.dones()[i] == 0);
+        }
+        check_outputs(env, states);
+    };
+
+    reset_all();
+    int num_dones = 0;
+    const std::vector<Action> no_plan;
+    std::vector<int> actions(kNumEnvs);
+    for (int step = 0; step < kNumSteps; ++step) {
+        if (step == kNumSteps / 2) {
+            env.reset();
+            reset_all();
+        }
+        std::vector<uint64_t> rewards(kNumEnvs);
+        std::vector<uint8_t> dones(kNumEnvs);
+        for (std::size_t i = 0; i < kNumEnvs; ++i) {
+            const auto &plan = plans.empty() ? no_plan : plans[plan_levels[i]].actions;
+            const auto action = i % 2 == 0 && plan_steps[i] < plan.size() ? plan[plan_steps[i]++]
+                                                                          : walk_action(states[i], rng);
+            actions[i] = static_cast<int>(action);
+            states[i].apply_action(action);
+            rewards[i] = states[i].get_reward_signal();
+            dones[i] = static_cast<uint8_t>(states[i].is_solution());
+        }
+        env.step(actions);
+        for (std::size_t i = 0; i < kNumEnvs; ++i) {
+            CHECK(env.reward_signals()[i] == rewards[i]);
+            CHECK(env.dones()[i] == dones[i]);
+            if (dones[i] != 0) {
+                ++num_dones;
+                states[i] = reset_env(i);
+            }
+        }
+        check_outputs(env, states);
+    }
+    CHECK(num_dones > 0 || plans.empty());
+    return resets;
+}
+
+void test_matches_states() {
+    for (const auto &level_set : level_sets()) {
+        std::vector<SolverResult> plans;
+        if (level_set.follow_plans) {
+            std::vector<CraftWorldGameState> levels;
+            for (const auto &board_str : level_set.board_strs) {
+                levels.emplace_back(board_str);
+            }
+            plans = solve_all(levels, {.algorithm = SearchAlgorithm::kAStar}, 4);
+        }
+        // Levels are sampled per environment, so the thread count does not change them
+        const auto resets = run(level_set, plans, 1);
+        CHECK(run(level_set, plans, 4) == resets);
+    }
+}
+
+void test_invalid_actions() {
+    CraftWorldVecEnv env(load_problems("test_100"), kNumEnvs);
+    CHECK_THROWS(env.step(std::vector<int>(kNumEnvs - 1, 0)), std::invalid_argument);
+    CHECK_THROWS(env.step(std::vector<int>(kNumEnvs, kNumActions)), std::invalid_argument);
+    CHECK_THROWS((void)env.get_state(kNumEnvs), std::invalid_argument);
+    CHECK_THROWS((CraftWorldVecEnv{{}, kNumEnvs}), std::invalid_argument);
+}
+
+}    // namespace
+
+int main() {
+    test_matches_states();
+    test_invalid_actions();
+    return finish("test_vec_env");
+}
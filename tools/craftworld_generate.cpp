@@ -0,0 +1,89 @@
+#include <craftworld/craftworld.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace craftworld;
+
+namespace {
+void print_usage() {
+    std::cerr << "usage: craftworld_generate --export_path PATH [--num_train N] [--num_test N] [--map_size N] "
+                 "[--num_primitive N] [--num_grass N] [--hard] [--solvable] [--seed N] [--threads N]"
+              << std::endl;
+}
+
+void write_levels(const std::filesystem::path &path, const std::vector<std::string> &board_strs) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::invalid_argument("Unable to open " + path.string());
+    }
+    for (const auto &board_str : board_strs) {
+        file << board_str << "\n";
+    }
+}
+}    // namespace
+
+// Generate train.txt and test.txt level sets, with the same options as scripts/scenario_create.py
+int main(int argc, char **argv) {
+    GeneratorOptions options;
+    std::string export_path;
+    int num_train = 10000;
+    int num_test = 1000;
+    uint64_t seed = 0;
+    int num_threads = 1;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--export_path" && has_value) {
+            export_path = argv[++i];
+        } else if (arg == "--num_train" && has_value) {
+            num_train = std::atoi(argv[++i]);
+        } else if (arg == "--num_test" && has_value) {
+            num_test = std::atoi(argv[++i]);
+        } else if (arg == "--map_size" && has_value) {
+            options.map_size = std::atoi(argv[++i]);
+        } else if (arg == "--num_primitive" && has_value) {
+            options.num_primitive = std::atoi(argv[++i]);
+        } else if (arg == "--num_grass" && has_value) {
+            options.num_grass = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && has_value) {
+            num_threads = std::atoi(argv[++i]);
+        } else if (arg == "--hard") {
+            options.hard = true;
+        } else if (arg == "--solvable") {
+            options.require_solvable = true;
+        } else {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (export_path.empty()) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    try {
+        // Train and test levels use consecutive seeds, so the two sets never share a level seed
+        GeneratorOptions train_options = options;
+        GeneratorOptions test_options = options;
+        train_options.goal_probs = options.hard ? kGoalProbsTrainHard : kGoalProbsTrain;
+        test_options.goal_probs = options.hard ? kGoalProbsTestHard : kGoalProbsTest;
+        const auto train = generate_board_strs(train_options, num_train, seed, num_threads);
+        const auto test =
+            generate_board_strs(test_options, num_test, seed + static_cast<uint64_t>(num_train), num_threads);
+        std::filesystem::create_directories(export_path);
+        write_levels(std::filesystem::path(export_path) / "train.txt", train);
+        write_levels(std::filesystem::path(export_path) / "test.txt", test);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+#include <craftworld/craftworld.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace craftworld;
+
+// Convert a problems file into a binary level pack, one level at a time
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "usage: craftworld_pack <problems_file> <pack_file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::ifstream problems(argv[1]);
+    if (!problems) {
+        std::cerr << "Unable to open " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        LevelPackWriter writer(argv[2]);
+        std::string line;
+        for (int line_num = 1; std::getline(problems, line); ++line_num) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            try {
+                writer.add(CraftWorldGameState(line));
+            } catch (const std::invalid_argument &e) {
+                throw std::invalid_argument("line " + std::to_string(line_num) + ": " + e.what());
+            }
+        }
+        writer.finish();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
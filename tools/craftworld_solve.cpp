@@ -0,0 +1,56 @@
+#include <craftworld/craftworld.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace craftworld;
+
+namespace {
+void print_usage() {
+    std::cerr << "usage: craftworld_solve <problems_file> [--astar] [--threads N] [--max-expansions N]" << std::endl;
+}
+}    // namespace
+
+// Solve each level of a problems file, printing the plan length and actions per level (-1 if not solved)
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    SolverOptions options;
+    int num_threads = 1;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--astar") {
+            options.algorithm = SearchAlgorithm::kAStar;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            num_threads = std::atoi(argv[++i]);
+        } else if (arg == "--max-expansions" && i + 1 < argc) {
+            options.max_expansions = std::atoll(argv[++i]);
+        } else {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        const auto results = solve_all(load_levels(argv[1], num_threads), options, num_threads);
+        for (const auto &result : results) {
+            if (result.status != SolverStatus::kSolved) {
+                std::cout << -1 << std::endl;
+                continue;
+            }
+            std::cout << result.actions.size();
+            for (const auto &action : result.actions) {
+                std::cout << " " << kActionToString.at(action);
+            }
+            std::cout << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}